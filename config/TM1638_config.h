@@ -43,6 +43,73 @@ extern "C" {
  */   
 #define TM1638_CONFIG_SUPPORT_COM_ANODE  1
 
+/**
+ * @brief  Cost of starting a new STB frame in bit times
+ * @note   Used to decide whether unchanged registers between two changed ones
+ *         are resent in one burst or a new frame is started. Increase it for
+ *         transports with expensive frame setup (e.g. SPI drivers).
+ */
+#define TM1638_CONFIG_FRAME_OVERHEAD_BITS  16
+
+/**
+ * @brief  Enable double-buffered register image
+ * @note   Digit functions draw into a back buffer which is published with
+ *         TM1638_SwapBuffers() and sent by the next TM1638_Flush().
+ *         It needs 32 bytes of extra RAM per handler.
+ */
+#define TM1638_CONFIG_DOUBLE_BUFFER  0
+
+/**
+ * @brief  Bind DIO, CLK and STB pins at compile time
+ * @note   If enabled, TM1638.c includes "TM1638_platform.h" which must provide
+ *         the following static inline functions. They are used instead of
+ *         the GPIO functions and WriteByte/ReadByte of the handler:
+ *         - void TM1638_Static_DioConfigOut(void)
+ *         - void TM1638_Static_DioConfigIn(void)
+ *         - void TM1638_Static_DioWrite(uint8_t Level)
+ *         - uint8_t TM1638_Static_DioRead(void)
+ *         - void TM1638_Static_ClkWrite(uint8_t Level)
+ *         - void TM1638_Static_StbWrite(uint8_t Level)
+ */
+#define TM1638_CONFIG_STATIC_PINS  0
+
+/**
+ * @brief  Enable TM1638_Group_t to refresh several TM1638s with common CLK
+ *         and STB together
+ */
+#define TM1638_CONFIG_GROUP  0
+
+/**
+ * @brief  Maximum number of TM1638s in a group
+ */
+#define TM1638_CONFIG_GROUP_MAX_CHIPS  8
+
+/**
+ * @brief  Enable non-blocking flush and key scan
+ * @note   TM1638_FlushAsync() and TM1638_ScanKeysAsync() queue a job which is
+ *         clocked out by TM1638_Poll() calls from the main loop.
+ *         It needs about 50 bytes of extra RAM per handler.
+ */
+#define TM1638_CONFIG_ASYNC  0
+
+/**
+ * @brief  Maximum number of bits clocked by each TM1638_Poll() call
+ */
+#define TM1638_CONFIG_ASYNC_BITS_PER_POLL  8
+
+/**
+ * @brief  Enable per-digit brightness by time-multiplexing
+ * @note   TM1638_DimTick() shows each digit in Level of every
+ *         TM1638_CONFIG_DIM_STEPS ticks. It needs 16 * (DIM_STEPS + 2) + 1
+ *         bytes of extra RAM per handler.
+ */
+#define TM1638_CONFIG_DIMMING  0
+
+/**
+ * @brief  Number of ticks of a dimming cycle (number of dim levels)
+ */
+#define TM1638_CONFIG_DIM_STEPS  4
+
 
 
 #ifdef __cplusplus
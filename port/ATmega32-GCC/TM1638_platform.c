@@ -32,9 +32,31 @@
 #include "TM1638_platform.h"
 #include <avr/io.h>
 #include <util/delay.h>
+#include <util/delay_basic.h>
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <stddef.h>
+#endif
 
 
 
+/* Private Variables ------------------------------------------------------------*/
+static TM1638_Platform_Pins_t TM1638_DefaultPins =
+{
+  .ClkDdr = &TM1638_CLK_DDR, .ClkPort = &TM1638_CLK_PORT,
+  .ClkMask = (1<<TM1638_CLK_NUM),
+  .DioDdr = &TM1638_DIO_DDR, .DioPort = &TM1638_DIO_PORT,
+  .DioPin = &TM1638_DIO_PIN, .DioMask = (1<<TM1638_DIO_NUM),
+  .StbDdr = &TM1638_STB_DDR, .StbPort = &TM1638_STB_PORT,
+  .StbMask = (1<<TM1638_STB_NUM),
+};
+
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+static TM1638_Handler_t *TM1638_TimerHandlers[TM1638_TIMER_MAX_HANDLERS];
+#endif
+
+
 
 /**
  ==================================================================================
@@ -43,76 +65,253 @@
  */
 
 static void
-TM1638_PlatformInit(void)
+TM1638_PlatformInit(void *Context)
 {
-  TM1638_CLK_DDR |= (1<<TM1638_CLK_NUM);
-  TM1638_DIO_DDR |= (1<<TM1638_DIO_NUM);
-  TM1638_STB_DDR |= (1<<TM1638_STB_NUM);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  *Pins->ClkDdr |= Pins->ClkMask;
+  *Pins->DioDdr |= Pins->DioMask;
+  *Pins->StbDdr |= Pins->StbMask;
+
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+  // CTC mode, prescaler 8
+  TCCR2 = (1<<WGM21) | (1<<CS21);
+  OCR2 = (F_CPU / 8UL) * TM1638_TIMER_TICK_US / 1000000UL - 1;
+#endif
 }
 
 static void
-TM1638_PlatformDeInit(void)
+TM1638_PlatformDeInit(void *Context)
 {
-  TM1638_CLK_DDR &= ~(1<<TM1638_CLK_NUM);
-  TM1638_CLK_PORT &= ~(1<<TM1638_CLK_NUM);
-  TM1638_DIO_DDR &= ~(1<<TM1638_DIO_NUM);
-  TM1638_DIO_PORT &= ~(1<<TM1638_DIO_NUM);
-  TM1638_STB_DDR &= ~(1<<TM1638_STB_NUM);
-  TM1638_STB_PORT &= ~(1<<TM1638_STB_NUM);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  *Pins->ClkDdr &= ~Pins->ClkMask;
+  *Pins->ClkPort &= ~Pins->ClkMask;
+  *Pins->DioDdr &= ~Pins->DioMask;
+  *Pins->DioPort &= ~Pins->DioMask;
+  *Pins->StbDdr &= ~Pins->StbMask;
+  *Pins->StbPort &= ~Pins->StbMask;
+
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+  // Free timer slots of handlers on these pins, the ISR must not see them
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    uint8_t Running = 0;
+
+    for (uint8_t i = 0; i < TM1638_TIMER_MAX_HANDLERS; i++)
+    {
+      if (!TM1638_TimerHandlers[i])
+        continue;
+      if (TM1638_TimerHandlers[i]->Context == Context)
+        TM1638_TimerHandlers[i] = NULL;
+      else if (TM1638_TimerHandlers[i]->Async.Busy)
+        Running = 1;
+    }
+
+    if (!Running)
+      TIMSK &= ~(1<<OCIE2);
+  }
+#endif
 }
 
 static void
-TM1638_DioConfigOut(void)
+TM1638_DioConfigOut(void *Context)
 {
-  TM1638_DIO_DDR |= (1<<TM1638_DIO_NUM);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  *Pins->DioDdr |= Pins->DioMask;
 }
 
 static void
-TM1638_DioConfigIn(void)
+TM1638_DioConfigIn(void *Context)
 {
-  TM1638_DIO_DDR &= ~(1<<TM1638_DIO_NUM);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  *Pins->DioDdr &= ~Pins->DioMask;
 }
 
 static void
-TM1638_DioWrite(uint8_t Level)
+TM1638_DioWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if (Level)
-    TM1638_DIO_PORT |= (1<<TM1638_DIO_NUM);
+    *Pins->DioPort |= Pins->DioMask;
   else
-    TM1638_DIO_PORT &= ~(1<<TM1638_DIO_NUM);
+    *Pins->DioPort &= ~Pins->DioMask;
 }
 
 static uint8_t
-TM1638_DioRead(void)
+TM1638_DioRead(void *Context)
 {
-  return (TM1638_DIO_PIN & (1 << TM1638_DIO_NUM)) ? 1 : 0;
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  return (*Pins->DioPin & Pins->DioMask) ? 1 : 0;
 }
 
 static void
-TM1638_ClkWrite(uint8_t Level)
+TM1638_ClkWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if (Level)
-    TM1638_CLK_PORT |= (1<<TM1638_CLK_NUM);
+    *Pins->ClkPort |= Pins->ClkMask;
   else
-    TM1638_CLK_PORT &= ~(1<<TM1638_CLK_NUM);
+    *Pins->ClkPort &= ~Pins->ClkMask;
 }
 
 static void
-TM1638_StbWrite(uint8_t Level)
+TM1638_StbWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if (Level)
-    TM1638_STB_PORT |= (1<<TM1638_STB_NUM);
+    *Pins->StbPort |= Pins->StbMask;
   else
-    TM1638_STB_PORT &= ~(1<<TM1638_STB_NUM);
+    *Pins->StbPort &= ~Pins->StbMask;
 }
 
 static void
-TM1638_DelayUs(uint8_t Delay)
+TM1638_DelayUs(void *Context, uint8_t Delay)
 {
+  (void)Context;
+
   for (; Delay; --Delay)
     _delay_us(1);
 }
 
+static void
+TM1638_DelayCycles(void *Context, uint16_t Cycles)
+{
+  (void)Context;
+
+  // _delay_loop_2 takes 4 cycles per iteration
+  if (Cycles >= 4)
+    _delay_loop_2(Cycles >> 2);
+}
+
+#if (TM1638_USE_BYTE_IO)
+static void
+TM1638_WriteByte(void *Context, uint8_t Data, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  volatile uint8_t *ClkPort = Pins->ClkPort;
+  volatile uint8_t *DioPort = Pins->DioPort;
+
+  for (uint8_t i = 0; i < 8; ++i, Data >>= 1)
+  {
+    *ClkPort &= ~Pins->ClkMask;
+    if (Data & 0x01)
+      *DioPort |= Pins->DioMask;
+    else
+      *DioPort &= ~Pins->DioMask;
+    if (Delay->ClkLow)
+      TM1638_DelayCycles(Context, Delay->ClkLow);
+    *ClkPort |= Pins->ClkMask;
+    if (Delay->ClkHigh)
+      TM1638_DelayCycles(Context, Delay->ClkHigh);
+  }
+}
+
+static uint8_t
+TM1638_ReadByte(void *Context, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  uint8_t Data = 0;
+
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    *Pins->ClkPort &= ~Pins->ClkMask;
+    if (Delay->ClkLow)
+      TM1638_DelayCycles(Context, Delay->ClkLow);
+    *Pins->ClkPort |= Pins->ClkMask;
+    if (*Pins->DioPin & Pins->DioMask)
+      Data |= (1 << i);
+    if (Delay->ClkHigh)
+      TM1638_DelayCycles(Context, Delay->ClkHigh);
+  }
+
+  return Data;
+}
+#endif
+
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+static void
+TM1638_TimerStart(void *Context)
+{
+  (void)Context;
+
+  // Timer may already run for the job of another handler
+  if (TIMSK & (1<<OCIE2))
+    return;
+
+  TCNT2 = 0;
+  TIFR = (1<<OCF2);
+  TIMSK |= (1<<OCIE2);
+}
+
+static void
+TM1638_TimerStop(void *Context)
+{
+  (void)Context;
+
+  for (uint8_t i = 0; i < TM1638_TIMER_MAX_HANDLERS; i++)
+  {
+    if (TM1638_TimerHandlers[i] && TM1638_TimerHandlers[i]->Async.Busy)
+      return;
+  }
+
+  TIMSK &= ~(1<<OCIE2);
+}
+
+/**
+ * @brief  Give the handler a timer slot
+ * @retval 1 if the handler has a slot, 0 if all slots are taken
+ */
+static uint8_t
+TM1638_TimerRegister(TM1638_Handler_t *Handler)
+{
+  uint8_t Free = TM1638_TIMER_MAX_HANDLERS;
+
+  for (uint8_t i = 0; i < TM1638_TIMER_MAX_HANDLERS; i++)
+  {
+    if (TM1638_TimerHandlers[i] == Handler)
+      return 1;
+    if (!TM1638_TimerHandlers[i] && Free == TM1638_TIMER_MAX_HANDLERS)
+      Free = i;
+  }
+
+  if (Free == TM1638_TIMER_MAX_HANDLERS)
+    return 0;
+
+  // The interrupt may be walking the slots of running jobs
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    TM1638_TimerHandlers[Free] = Handler;
+  }
+  return 1;
+}
+
+ISR(TIMER2_COMP_vect)
+{
+  for (uint8_t i = 0; i < TM1638_TIMER_MAX_HANDLERS; i++)
+  {
+    if (TM1638_TimerHandlers[i])
+      TM1638_TimerTick(TM1638_TimerHandlers[i]);
+  }
+}
+#endif
+
+#if (TM1638_CONFIG_GROUP)
+static void
+TM1638_PortWrite(void *Context, uint32_t SetMask, uint32_t ClearMask)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  *Pins->ClkPort = (*Pins->ClkPort & ~(uint8_t)ClearMask) | (uint8_t)SetMask;
+}
+#endif
+
 
 
 /**
@@ -123,12 +322,29 @@ TM1638_DelayUs(uint8_t Delay)
  
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 TM1638_Platform_Init(TM1638_Handler_t *Handler)
 {
+  TM1638_Platform_InitPins(Handler, &TM1638_DefaultPins);
+}
+
+
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins)
+{
+  Handler->Context = Pins;
   Handler->PlatformInit = TM1638_PlatformInit;
   Handler->PlatformDeInit = TM1638_PlatformDeInit;
   Handler->DioConfigOut = TM1638_DioConfigOut;
@@ -138,4 +354,71 @@ TM1638_Platform_Init(TM1638_Handler_t *Handler)
   Handler->ClkWrite = TM1638_ClkWrite;
   Handler->StbWrite = TM1638_StbWrite;
   Handler->DelayUs = TM1638_DelayUs;
+  Handler->DelayCycles = TM1638_DelayCycles;
+  Handler->CpuFreqMHz = F_CPU / 1000000UL;
+#if (TM1638_USE_BYTE_IO)
+  Handler->WriteByte = TM1638_WriteByte;
+  Handler->ReadByte = TM1638_ReadByte;
+#endif
+#if (TM1638_USE_TIMER && TM1638_CONFIG_ASYNC)
+  if (TM1638_TimerRegister(Handler))
+  {
+    Handler->TimerStart = TM1638_TimerStart;
+    Handler->TimerStop = TM1638_TimerStop;
+  }
+#endif
+}
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group)
+{
+  TM1638_Platform_Pins_t *First = Group->Chips[0].Context;
+  TM1638_Platform_Pins_t *Pins, *Other;
+
+  // Chips on one DIO pin get the same mask, the others a mask of their own
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = 1UL << i;
+    for (uint8_t j = 0; j < i; j++)
+    {
+      Other = Group->Chips[j].Context;
+      if (Other->DioPort == Pins->DioPort && Other->DioMask == Pins->DioMask)
+      {
+        Group->DioMask[i] = Group->DioMask[j];
+        break;
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    if (Pins->ClkPort != First->ClkPort || Pins->DioPort != First->ClkPort ||
+        Pins->StbPort != First->ClkPort || Pins->ClkMask != First->ClkMask)
+      return;
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = Pins->DioMask;
+    Group->StbMask |= Pins->StbMask;
+  }
+
+  Group->Context = First;
+  Group->ClkMask = First->ClkMask;
+  Group->PortWrite = TM1638_PortWrite;
 }
+#endif
@@ -58,6 +58,95 @@ extern "C" {
 #define TM1638_STB_PORT     PORTA
 #define TM1638_STB_NUM      2
 
+/**
+ * @brief  Clock asynchronous jobs by Timer2 compare interrupt
+ * @note   It needs 'TM1638_CONFIG_ASYNC' and global interrupts enabled.
+ *         Each interrupt emits one clock half-period of every running job.
+ *         Timer2 must not be used by the application.
+ * @note   Up to TM1638_TIMER_MAX_HANDLERS handlers get a timer slot, further
+ *         ones are clocked by TM1638_Poll().
+ */
+#define TM1638_USE_TIMER          0
+#define TM1638_TIMER_TICK_US      10
+#define TM1638_TIMER_MAX_HANDLERS 4
+
+/**
+ * @brief  Install whole-byte callbacks for faster bit-banging
+ * @note   They apply the timing profile of TM1638_SetTiming to each bit but
+ *         save the per-bit GPIO callback calls of the driver.
+ */
+#define TM1638_USE_BYTE_IO  1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Pins descriptor of a TM1638 (used as handler Context)
+ */
+typedef struct TM1638_Platform_Pins_s
+{
+  volatile uint8_t *ClkDdr;
+  volatile uint8_t *ClkPort;
+  uint8_t ClkMask;
+  volatile uint8_t *DioDdr;
+  volatile uint8_t *DioPort;
+  volatile uint8_t *DioPin;
+  uint8_t DioMask;
+  volatile uint8_t *StbDdr;
+  volatile uint8_t *StbPort;
+  uint8_t StbMask;
+} TM1638_Platform_Pins_t;
+
+
+/* Static Pin Functions ---------------------------------------------------------*/
+#if (TM1638_CONFIG_STATIC_PINS)
+#include <avr/io.h>
+
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  TM1638_DIO_DDR |= (1<<TM1638_DIO_NUM);
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  TM1638_DIO_DDR &= ~(1<<TM1638_DIO_NUM);
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  if (Level)
+    TM1638_DIO_PORT |= (1<<TM1638_DIO_NUM);
+  else
+    TM1638_DIO_PORT &= ~(1<<TM1638_DIO_NUM);
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return (TM1638_DIO_PIN & (1 << TM1638_DIO_NUM)) ? 1 : 0;
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  if (Level)
+    TM1638_CLK_PORT |= (1<<TM1638_CLK_NUM);
+  else
+    TM1638_CLK_PORT &= ~(1<<TM1638_CLK_NUM);
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  if (Level)
+    TM1638_STB_PORT |= (1<<TM1638_STB_NUM);
+  else
+    TM1638_STB_PORT &= ~(1<<TM1638_STB_NUM);
+}
+#endif
+
 
 
 /**
@@ -68,6 +157,7 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -75,6 +165,33 @@ void
 TM1638_Platform_Init(TM1638_Handler_t *Handler);
 
 
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins);
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -33,6 +33,22 @@
 #include "freertos/FreeRTOS.h"
 #include "driver/gpio.h"
 #include "rom/ets_sys.h"
+#include "esp_cpu.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#if (TM1638_USE_SPI)
+#include <string.h>
+#include "driver/spi_master.h"
+#endif
+
+
+/* Private variables ------------------------------------------------------------*/
+static TM1638_Platform_Pins_t TM1638_DefaultPins =
+{
+  .Clk = TM1638_CLK_GPIO,
+  .Dio = TM1638_DIO_GPIO,
+  .Stb = TM1638_STB_GPIO,
+};
 
 
 
@@ -59,62 +75,201 @@ TM1638_SetGPIO_IN_PU(gpio_num_t GPIO_Pad)
 
 
 static void
-TM1638_PlatformInit(void)
+TM1638_PlatformInit(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_CLK_GPIO);
-  TM1638_SetGPIO_OUT(TM1638_STB_GPIO);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+#if (TM1638_USE_SPI)
+  spi_bus_config_t BusConfig = {
+    .mosi_io_num = Pins->Dio,
+    .miso_io_num = -1,
+    .sclk_io_num = Pins->Clk,
+    .quadwp_io_num = -1,
+    .quadhd_io_num = -1,
+  };
+  spi_device_interface_config_t DevConfig = {
+    .mode = 3,
+    .clock_speed_hz = TM1638_SPI_CLOCK_HZ,
+    .spics_io_num = Pins->Stb,
+    .flags = SPI_DEVICE_3WIRE | SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_BIT_LSBFIRST,
+    .queue_size = 1,
+  };
+
+  // The bus may already be initialized by another TM1638 sharing CLK and DIO
+  spi_bus_initialize(TM1638_SPI_HOST, &BusConfig, SPI_DMA_DISABLED);
+  spi_bus_add_device(TM1638_SPI_HOST, &DevConfig, &Pins->SpiDevice);
+  gpio_set_pull_mode(Pins->Dio, GPIO_PULLUP_ONLY);
+#else
+  TM1638_SetGPIO_OUT(Pins->Clk);
+  TM1638_SetGPIO_OUT(Pins->Stb);
+  TM1638_SetGPIO_IN_PU(Pins->Dio);
+#endif
 }
 
 static void
-TM1638_PlatformDeInit(void)
+TM1638_PlatformDeInit(void *Context)
 {
-  gpio_reset_pin(TM1638_CLK_GPIO);
-  gpio_reset_pin(TM1638_STB_GPIO);
-  gpio_reset_pin(TM1638_DIO_GPIO);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+#if (TM1638_USE_SPI)
+  spi_bus_remove_device(Pins->SpiDevice);
+  // It fails if other devices are still on the bus
+  spi_bus_free(TM1638_SPI_HOST);
+#endif
+  gpio_reset_pin(Pins->Clk);
+  gpio_reset_pin(Pins->Stb);
+  gpio_reset_pin(Pins->Dio);
 }
 
 static void
-TM1638_DioConfigOut(void)
+TM1638_DioConfigOut(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_DIO_GPIO);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  // DIO pad is configured once in PlatformInit, only toggle the output driver
+  gpio_ll_output_enable(&GPIO, Pins->Dio);
 }
 
 static void
-TM1638_DioConfigIn(void)
+TM1638_DioConfigIn(void *Context)
 {
-  TM1638_SetGPIO_IN_PU(TM1638_DIO_GPIO);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  gpio_ll_output_disable(&GPIO, Pins->Dio);
 }
 
 static void
-TM1638_DioWrite(uint8_t Level)
+TM1638_DioWrite(void *Context, uint8_t Level)
 {
-  gpio_set_level(TM1638_DIO_GPIO, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  gpio_set_level(Pins->Dio, Level);
 }
 
 static uint8_t
-TM1638_DioRead(void)
+TM1638_DioRead(void *Context)
 {
-  return gpio_get_level(TM1638_DIO_GPIO);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  return gpio_get_level(Pins->Dio);
 }
 
 static void
-TM1638_ClkWrite(uint8_t Level)
+TM1638_ClkWrite(void *Context, uint8_t Level)
 {
-  gpio_set_level(TM1638_CLK_GPIO, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  gpio_set_level(Pins->Clk, Level);
 }
 
 static void
-TM1638_StbWrite(uint8_t Level)
+TM1638_StbWrite(void *Context, uint8_t Level)
 {
-  gpio_set_level(TM1638_STB_GPIO, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  gpio_set_level(Pins->Stb, Level);
 }
 
 static void
-TM1638_DelayUs(uint8_t Delay)
+TM1638_DelayUs(void *Context, uint8_t Delay)
 {
+  (void)Context;
+
   ets_delay_us(Delay);
 }
 
+static void
+TM1638_DelayCycles(void *Context, uint16_t Cycles)
+{
+  esp_cpu_cycle_count_t Start = esp_cpu_get_cycle_count();
+
+  (void)Context;
+
+  while ((esp_cpu_cycle_count_t)(esp_cpu_get_cycle_count() - Start) < Cycles);
+}
+
+#if (TM1638_USE_BYTE_IO)
+static void
+TM1638_WriteByte(void *Context, uint8_t Data, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  for (uint8_t i = 0; i < 8; ++i, Data >>= 1)
+  {
+    gpio_ll_set_level(&GPIO, Pins->Clk, 0);
+    gpio_ll_set_level(&GPIO, Pins->Dio, Data & 0x01);
+    if (Delay->ClkLow)
+      TM1638_DelayCycles(Context, Delay->ClkLow);
+    gpio_ll_set_level(&GPIO, Pins->Clk, 1);
+    if (Delay->ClkHigh)
+      TM1638_DelayCycles(Context, Delay->ClkHigh);
+  }
+}
+
+static uint8_t
+TM1638_ReadByte(void *Context, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  uint8_t Data = 0;
+
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    gpio_ll_set_level(&GPIO, Pins->Clk, 0);
+    if (Delay->ClkLow)
+      TM1638_DelayCycles(Context, Delay->ClkLow);
+    gpio_ll_set_level(&GPIO, Pins->Clk, 1);
+    Data |= (gpio_ll_get_level(&GPIO, Pins->Dio) << i);
+    if (Delay->ClkHigh)
+      TM1638_DelayCycles(Context, Delay->ClkHigh);
+  }
+
+  return Data;
+}
+#endif
+
+#if (TM1638_USE_SPI)
+static void
+TM1638_Transfer(void *Context, uint8_t Command,
+                const uint8_t *TxData, uint8_t TxLen,
+                uint8_t *RxData, uint8_t RxLen,
+                const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  uint8_t TxBuffer[17];
+  spi_transaction_t Transaction = {0};
+
+  if (TxLen > sizeof(TxBuffer) - 1)
+    TxLen = sizeof(TxBuffer) - 1;
+
+  TxBuffer[0] = Command;
+  if (TxLen)
+    memcpy(&TxBuffer[1], TxData, TxLen);
+
+  Transaction.length = (TxLen + 1) * 8;
+  Transaction.tx_buffer = TxBuffer;
+
+  if (RxLen == 0)
+  {
+    spi_device_polling_transmit(Pins->SpiDevice, &Transaction);
+    return;
+  }
+
+  // Keep STB low between the read command and the read phase (Twait)
+  spi_device_acquire_bus(Pins->SpiDevice, portMAX_DELAY);
+  Transaction.flags = SPI_TRANS_CS_KEEP_ACTIVE;
+  spi_device_polling_transmit(Pins->SpiDevice, &Transaction);
+  // Handler->DelayCycles is set, so the profile is in CPU cycles
+  if (Delay->ReadWait)
+    TM1638_DelayCycles(Context, Delay->ReadWait);
+
+  memset(&Transaction, 0, sizeof(Transaction));
+  Transaction.rxlength = RxLen * 8;
+  Transaction.rx_buffer = RxData;
+  spi_device_polling_transmit(Pins->SpiDevice, &Transaction);
+  spi_device_release_bus(Pins->SpiDevice);
+}
+#endif
+
 
 
 /**
@@ -125,12 +280,29 @@ TM1638_DelayUs(uint8_t Delay)
  
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 TM1638_Platform_Init(TM1638_Handler_t *Handler)
 {
+  TM1638_Platform_InitPins(Handler, &TM1638_DefaultPins);
+}
+
+
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins)
+{
+  Handler->Context = Pins;
   Handler->PlatformInit = TM1638_PlatformInit;
   Handler->PlatformDeInit = TM1638_PlatformDeInit;
   Handler->DioConfigOut = TM1638_DioConfigOut;
@@ -140,4 +312,13 @@ TM1638_Platform_Init(TM1638_Handler_t *Handler)
   Handler->ClkWrite = TM1638_ClkWrite;
   Handler->StbWrite = TM1638_StbWrite;
   Handler->DelayUs = TM1638_DelayUs;
+  Handler->DelayCycles = TM1638_DelayCycles;
+  Handler->CpuFreqMHz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ;
+#if (TM1638_USE_BYTE_IO)
+  Handler->WriteByte = TM1638_WriteByte;
+  Handler->ReadByte = TM1638_ReadByte;
+#endif
+#if (TM1638_USE_SPI)
+  Handler->Transfer = TM1638_Transfer;
+#endif
 }
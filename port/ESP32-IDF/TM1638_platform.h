@@ -50,6 +50,89 @@ extern "C" {
 #define TM1638_DIO_GPIO     GPIO_NUM_1
 #define TM1638_STB_GPIO     GPIO_NUM_2
 
+/**
+ * @brief  Use SPI peripheral instead of bit-banging CLK and DIO
+ * @note   The SPI bus is used in 3-wire half-duplex mode, LSB first, with
+ *         STB as chip select. TM1638_SPI_HOST must not be shared.
+ */
+#define TM1638_USE_SPI        0
+#define TM1638_SPI_HOST       SPI2_HOST
+#define TM1638_SPI_CLOCK_HZ   1000000
+
+/**
+ * @brief  Install whole-byte callbacks for faster bit-banging
+ * @note   They apply the timing profile of TM1638_SetTiming to each bit but
+ *         save the per-bit GPIO callback calls of the driver.
+ */
+#define TM1638_USE_BYTE_IO  1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+#include "driver/gpio.h"
+#if (TM1638_USE_SPI)
+#include "driver/spi_master.h"
+#endif
+
+/**
+ * @brief  Pins descriptor of a TM1638 (used as handler Context)
+ * @note   If TM1638_USE_SPI is enabled, TM1638s on the same SPI host share
+ *         CLK and DIO and only STB differs.
+ */
+typedef struct TM1638_Platform_Pins_s
+{
+  gpio_num_t Clk;
+  gpio_num_t Dio;
+  gpio_num_t Stb;
+#if (TM1638_USE_SPI)
+  // Set by library
+  spi_device_handle_t SpiDevice;
+#endif
+} TM1638_Platform_Pins_t;
+
+
+/* Static Pin Functions ---------------------------------------------------------*/
+#if (TM1638_CONFIG_STATIC_PINS)
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  gpio_ll_output_enable(&GPIO, TM1638_DIO_GPIO);
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  gpio_ll_output_disable(&GPIO, TM1638_DIO_GPIO);
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  gpio_ll_set_level(&GPIO, TM1638_DIO_GPIO, Level);
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return gpio_ll_get_level(&GPIO, TM1638_DIO_GPIO);
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  gpio_ll_set_level(&GPIO, TM1638_CLK_GPIO, Level);
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  gpio_ll_set_level(&GPIO, TM1638_STB_GPIO, Level);
+}
+#endif
+
 
 
 /**
@@ -60,6 +143,7 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -67,6 +151,18 @@ void
 TM1638_Platform_Init(TM1638_Handler_t *Handler);
 
 
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins);
+
+
 
 #ifdef __cplusplus
 }
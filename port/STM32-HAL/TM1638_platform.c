@@ -33,6 +33,25 @@
 #include "main.h"
 
 
+/* Private variables ------------------------------------------------------------*/
+#if (TM1638_USE_SPI)
+extern SPI_HandleTypeDef TM1638_SPI_HANDLE;
+#endif
+
+static TM1638_Platform_Pins_t TM1638_DefaultPins =
+{
+  .ClkGpio = TM1638_CLK_GPIO,
+  .ClkPin = TM1638_CLK_PIN,
+  .DioGpio = TM1638_DIO_GPIO,
+  .DioPin = TM1638_DIO_PIN,
+  .StbGpio = TM1638_STB_GPIO,
+  .StbPin = TM1638_STB_PIN,
+#if (TM1638_USE_SPI)
+  .Spi = &TM1638_SPI_HANDLE,
+#endif
+};
+
+
 
 /**
  ==================================================================================
@@ -64,62 +83,180 @@ TM1638_SetGPIO_IN_PU(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
 
 
 static void
-TM1638_PlatformInit(void)
+TM1638_PlatformInit(void *Context)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  TM1638_SetGPIO_OUT(Pins->StbGpio, Pins->StbPin);
+  HAL_GPIO_WritePin(Pins->StbGpio, Pins->StbPin, 1);
+#if (TM1638_USE_SPI == 0)
+  TM1638_SetGPIO_OUT(Pins->ClkGpio, Pins->ClkPin);
+  TM1638_SetGPIO_IN_PU(Pins->DioGpio, Pins->DioPin);
+#endif
+}
+
+static void
+TM1638_PlatformDeInit(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_CLK_GPIO, TM1638_CLK_PIN);
-  TM1638_SetGPIO_OUT(TM1638_STB_GPIO, TM1638_STB_PIN);
-  TM1638_SetGPIO_OUT(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  (void)Context;
 }
 
 static void
-TM1638_PlatformDeInit(void)
+TM1638_SetDioMode(TM1638_Platform_Pins_t *Pins, uint8_t Output)
 {
+  uint32_t Position = 0;
+
+  while (((uint32_t)Pins->DioPin >> Position) > 1U)
+    Position++;
+
+#if defined(GPIO_CRL_MODE0)
+  // STM32F1: output push-pull 2MHz or input with pull-up/down
+  volatile uint32_t *CR = (Position < 8U) ?
+                          &Pins->DioGpio->CRL : &Pins->DioGpio->CRH;
+  uint32_t Shift = (Position & 0x07U) * 4U;
+  MODIFY_REG(*CR, 0x0FU << Shift, (Output ? 0x02U : 0x08U) << Shift);
+#else
+  uint32_t Shift = Position * 2U;
+  MODIFY_REG(Pins->DioGpio->MODER, 0x03U << Shift, (Output ? 0x01U : 0x00U) << Shift);
+#endif
 }
 
 static void
-TM1638_DioConfigOut(void)
+TM1638_DioConfigOut(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_SetDioMode(Context, 1);
 }
 
 static void
-TM1638_DioConfigIn(void)
+TM1638_DioConfigIn(void *Context)
 {
-  TM1638_SetGPIO_IN_PU(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  // Release the line first. On STM32F1 this also selects the pull-up.
+  Pins->DioGpio->BSRR = Pins->DioPin;
+  TM1638_SetDioMode(Context, 0);
 }
 
 static void
-TM1638_DioWrite(uint8_t Level)
+TM1638_DioWrite(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(TM1638_DIO_GPIO, TM1638_DIO_PIN, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  HAL_GPIO_WritePin(Pins->DioGpio, Pins->DioPin, Level);
 }
 
 static uint8_t
-TM1638_DioRead(void)
+TM1638_DioRead(void *Context)
 {
-  return HAL_GPIO_ReadPin(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  return HAL_GPIO_ReadPin(Pins->DioGpio, Pins->DioPin);
 }
 
 static void
-TM1638_ClkWrite(uint8_t Level)
+TM1638_ClkWrite(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(TM1638_CLK_GPIO, TM1638_CLK_PIN, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  HAL_GPIO_WritePin(Pins->ClkGpio, Pins->ClkPin, Level);
 }
 
 static void
-TM1638_StbWrite(uint8_t Level)
+TM1638_StbWrite(void *Context, uint8_t Level)
 {
-  HAL_GPIO_WritePin(TM1638_STB_GPIO, TM1638_STB_PIN, Level);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  HAL_GPIO_WritePin(Pins->StbGpio, Pins->StbPin, Level);
 }
 
 static void
-TM1638_DelayUs(uint8_t Delay)
+TM1638_DelayUs(void *Context, uint8_t Delay)
 {
+  (void)Context;
+
   // TODO: Implement a proper delay function. This one is not accurate.
   for (uint32_t DelayCounter = 0; DelayCounter < 100 * Delay; DelayCounter++)
     DelayCounter = DelayCounter;
 }
 
+#if (TM1638_USE_BYTE_IO)
+static void
+TM1638_WriteByte(void *Context, uint8_t Data, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  for (uint8_t i = 0; i < 8; ++i, Data >>= 1)
+  {
+    Pins->ClkGpio->BSRR = (uint32_t)Pins->ClkPin << 16;
+    if (Data & 0x01)
+      Pins->DioGpio->BSRR = Pins->DioPin;
+    else
+      Pins->DioGpio->BSRR = (uint32_t)Pins->DioPin << 16;
+    if (Delay->ClkLow)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkLow);
+    Pins->ClkGpio->BSRR = Pins->ClkPin;
+    if (Delay->ClkHigh)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkHigh);
+  }
+}
+
+static uint8_t
+TM1638_ReadByte(void *Context, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  uint8_t Data = 0;
+
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    Pins->ClkGpio->BSRR = (uint32_t)Pins->ClkPin << 16;
+    if (Delay->ClkLow)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkLow);
+    Pins->ClkGpio->BSRR = Pins->ClkPin;
+    if (Pins->DioGpio->IDR & Pins->DioPin)
+      Data |= (1 << i);
+    if (Delay->ClkHigh)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkHigh);
+  }
+
+  return Data;
+}
+#endif
+
+#if (TM1638_USE_SPI)
+static void
+TM1638_Transfer(void *Context, uint8_t Command,
+                const uint8_t *TxData, uint8_t TxLen,
+                uint8_t *RxData, uint8_t RxLen,
+                const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  HAL_GPIO_WritePin(Pins->StbGpio, Pins->StbPin, 0);
+
+  HAL_SPI_Transmit(Pins->Spi, &Command, 1, HAL_MAX_DELAY);
+  if (TxLen)
+    HAL_SPI_Transmit(Pins->Spi, (uint8_t *)TxData, TxLen, HAL_MAX_DELAY);
+  if (RxLen)
+  {
+    if (Delay->ReadWait)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ReadWait);
+    HAL_SPI_Receive(Pins->Spi, RxData, RxLen, HAL_MAX_DELAY);
+  }
+
+  HAL_GPIO_WritePin(Pins->StbGpio, Pins->StbPin, 1);
+}
+#endif
+
+#if (TM1638_CONFIG_GROUP)
+static void
+TM1638_PortWrite(void *Context, uint32_t SetMask, uint32_t ClearMask)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  Pins->ClkGpio->BSRR = SetMask | (ClearMask << 16);
+}
+#endif
+
 
 
 /**
@@ -130,12 +267,29 @@ TM1638_DelayUs(uint8_t Delay)
  
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 TM1638_Platform_Init(TM1638_Handler_t *Handler)
 {
+  TM1638_Platform_InitPins(Handler, &TM1638_DefaultPins);
+}
+
+
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins)
+{
+  Handler->Context = Pins;
   Handler->PlatformInit = TM1638_PlatformInit;
   Handler->PlatformDeInit = TM1638_PlatformDeInit;
   Handler->DioConfigOut = TM1638_DioConfigOut;
@@ -145,4 +299,65 @@ TM1638_Platform_Init(TM1638_Handler_t *Handler)
   Handler->ClkWrite = TM1638_ClkWrite;
   Handler->StbWrite = TM1638_StbWrite;
   Handler->DelayUs = TM1638_DelayUs;
+#if (TM1638_USE_BYTE_IO)
+  Handler->WriteByte = TM1638_WriteByte;
+  Handler->ReadByte = TM1638_ReadByte;
+#endif
+#if (TM1638_USE_SPI)
+  Handler->Transfer = TM1638_Transfer;
+#endif
+}
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group)
+{
+  TM1638_Platform_Pins_t *First = Group->Chips[0].Context;
+  TM1638_Platform_Pins_t *Pins, *Other;
+
+  // Chips on one DIO pin get the same mask, the others a mask of their own
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = 1UL << i;
+    for (uint8_t j = 0; j < i; j++)
+    {
+      Other = Group->Chips[j].Context;
+      if (Other->DioGpio == Pins->DioGpio && Other->DioPin == Pins->DioPin)
+      {
+        Group->DioMask[i] = Group->DioMask[j];
+        break;
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    if (Pins->ClkGpio != First->ClkGpio || Pins->DioGpio != First->ClkGpio ||
+        Pins->StbGpio != First->ClkGpio || Pins->ClkPin != First->ClkPin)
+      return;
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = Pins->DioPin;
+    Group->StbMask |= Pins->StbPin;
+  }
+
+  Group->Context = First;
+  Group->ClkMask = First->ClkPin;
+  Group->PortWrite = TM1638_PortWrite;
 }
+#endif
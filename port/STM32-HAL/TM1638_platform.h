@@ -53,6 +53,103 @@ extern "C" {
 #define TM1638_STB_GPIO     GPIOA
 #define TM1638_STB_PIN      GPIO_PIN_2
 
+/**
+ * @brief  Use SPI peripheral instead of bit-banging CLK and DIO
+ * @note   The SPI must be configured as master, 1-line bidirectional
+ *         (SPI_DIRECTION_1LINE), 8-bit, LSB first, CPOL high and CPHA 2-edge.
+ *         CLK and DIO must be connected to SCK and MOSI. STB stays a GPIO.
+ */
+#define TM1638_USE_SPI      0
+#define TM1638_SPI_HANDLE   hspi1
+
+/**
+ * @brief  Install whole-byte callbacks for faster bit-banging
+ * @note   They apply the timing profile of TM1638_SetTiming to each bit but
+ *         save the per-bit GPIO callback calls of the driver.
+ */
+#define TM1638_USE_BYTE_IO  1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+#include "main.h"
+
+/**
+ * @brief  Pins descriptor of a TM1638 (used as handler Context)
+ */
+typedef struct TM1638_Platform_Pins_s
+{
+  GPIO_TypeDef *ClkGpio;
+  uint16_t ClkPin;
+  GPIO_TypeDef *DioGpio;
+  uint16_t DioPin;
+  GPIO_TypeDef *StbGpio;
+  uint16_t StbPin;
+#if (TM1638_USE_SPI)
+  // SPI connected to CLK and DIO
+  SPI_HandleTypeDef *Spi;
+#endif
+} TM1638_Platform_Pins_t;
+
+
+/* Static Pin Functions ---------------------------------------------------------*/
+#if (TM1638_CONFIG_STATIC_PINS)
+#include "main.h"
+
+static inline void
+TM1638_Static_DioMode(uint8_t Output)
+{
+#if defined(GPIO_CRL_MODE0)
+  // STM32F1: output push-pull 2MHz or input with pull-up/down
+  volatile uint32_t *CR = (TM1638_DIO_PIN < 0x100U) ?
+                          &TM1638_DIO_GPIO->CRL : &TM1638_DIO_GPIO->CRH;
+  uint32_t Shift = ((uint32_t)__builtin_ctz(TM1638_DIO_PIN) & 0x07U) * 4U;
+  MODIFY_REG(*CR, 0x0FU << Shift, (Output ? 0x02U : 0x08U) << Shift);
+#else
+  uint32_t Shift = (uint32_t)__builtin_ctz(TM1638_DIO_PIN) * 2U;
+  MODIFY_REG(TM1638_DIO_GPIO->PUPDR, 0x03U << Shift, 0x01U << Shift);
+  MODIFY_REG(TM1638_DIO_GPIO->MODER, 0x03U << Shift, (Output ? 0x01U : 0x00U) << Shift);
+#endif
+}
+
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  TM1638_Static_DioMode(1);
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  // Release the line first. On STM32F1 this also selects the pull-up.
+  TM1638_DIO_GPIO->BSRR = TM1638_DIO_PIN;
+  TM1638_Static_DioMode(0);
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  TM1638_DIO_GPIO->BSRR = Level ? TM1638_DIO_PIN : ((uint32_t)TM1638_DIO_PIN << 16);
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return (TM1638_DIO_GPIO->IDR & TM1638_DIO_PIN) ? 1 : 0;
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  TM1638_CLK_GPIO->BSRR = Level ? TM1638_CLK_PIN : ((uint32_t)TM1638_CLK_PIN << 16);
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  TM1638_STB_GPIO->BSRR = Level ? TM1638_STB_PIN : ((uint32_t)TM1638_STB_PIN << 16);
+}
+#endif
+
 
 
 /**
@@ -63,6 +160,7 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -70,6 +168,33 @@ void
 TM1638_Platform_Init(TM1638_Handler_t *Handler);
 
 
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins);
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group);
+#endif
+
+
 
 #ifdef __cplusplus
 }
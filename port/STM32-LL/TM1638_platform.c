@@ -33,6 +33,31 @@
 #include "main.h"
 
 
+/* Private Macro ----------------------------------------------------------------*/
+/**
+ * @brief  Raw 16-bit port mask of an LL pin
+ * @note   On STM32F1 the LL pin values also carry the CRL/CRH position in
+ *         their upper bits.
+ */
+#if defined(GPIO_PIN_MASK_POS)
+#define TM1638_PIN_MASK(Pin)  (((Pin) >> GPIO_PIN_MASK_POS) & 0xFFFFU)
+#else
+#define TM1638_PIN_MASK(Pin)  (Pin)
+#endif
+
+
+/* Private variables ------------------------------------------------------------*/
+static TM1638_Platform_Pins_t TM1638_DefaultPins =
+{
+  .ClkGpio = TM1638_CLK_GPIO,
+  .ClkPin = TM1638_CLK_PIN,
+  .DioGpio = TM1638_DIO_GPIO,
+  .DioPin = TM1638_DIO_PIN,
+  .StbGpio = TM1638_STB_GPIO,
+  .StbPin = TM1638_STB_PIN,
+};
+
+
 
 /**
  ==================================================================================
@@ -67,83 +92,156 @@ TM1638_SetGPIO_IN_PU(GPIO_TypeDef *GPIOx, uint32_t GPIO_Pin)
 
 
 static void
-TM1638_PlatformInit(void)
+TM1638_PlatformInit(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_CLK_GPIO, TM1638_CLK_PIN);
-  TM1638_SetGPIO_OUT(TM1638_STB_GPIO, TM1638_STB_PIN);
-  TM1638_SetGPIO_OUT(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  TM1638_SetGPIO_OUT(Pins->ClkGpio, Pins->ClkPin);
+  TM1638_SetGPIO_OUT(Pins->StbGpio, Pins->StbPin);
+  TM1638_SetGPIO_IN_PU(Pins->DioGpio, Pins->DioPin);
 }
 
 static void
-TM1638_PlatformDeInit(void)
+TM1638_PlatformDeInit(void *Context)
 {
+  (void)Context;
 }
 
 static void
-TM1638_DioConfigOut(void)
+TM1638_DioConfigOut(void *Context)
 {
-  TM1638_SetGPIO_OUT(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  LL_GPIO_SetPinMode(Pins->DioGpio, Pins->DioPin, LL_GPIO_MODE_OUTPUT);
 }
 
 static void
-TM1638_DioConfigIn(void)
+TM1638_DioConfigIn(void *Context)
 {
-  TM1638_SetGPIO_IN_PU(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  // On STM32F1 the pull direction is shared with the output register
+  LL_GPIO_SetPinPull(Pins->DioGpio, Pins->DioPin, LL_GPIO_PULL_UP);
+  LL_GPIO_SetPinMode(Pins->DioGpio, Pins->DioPin, LL_GPIO_MODE_INPUT);
 }
 
 static void
-TM1638_DioWrite(uint8_t Level)
+TM1638_DioWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if(Level)
   {
-    LL_GPIO_SetOutputPin(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+    LL_GPIO_SetOutputPin(Pins->DioGpio, Pins->DioPin);
   }
   else
   {
-    LL_GPIO_ResetOutputPin(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+    LL_GPIO_ResetOutputPin(Pins->DioGpio, Pins->DioPin);
   }
 }
 
 static uint8_t
-TM1638_DioRead(void)
+TM1638_DioRead(void *Context)
 {
-  return (LL_GPIO_ReadInputPort(TM1638_DIO_GPIO) & TM1638_DIO_PIN) ? 1 : 0;
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  return (LL_GPIO_ReadInputPort(Pins->DioGpio) &
+          TM1638_PIN_MASK(Pins->DioPin)) ? 1 : 0;
 }
 
 static void
-TM1638_ClkWrite(uint8_t Level)
+TM1638_ClkWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if(Level)
   {
-    LL_GPIO_SetOutputPin(TM1638_CLK_GPIO, TM1638_CLK_PIN);
+    LL_GPIO_SetOutputPin(Pins->ClkGpio, Pins->ClkPin);
   }
   else
   {
-    LL_GPIO_ResetOutputPin(TM1638_CLK_GPIO, TM1638_CLK_PIN);
+    LL_GPIO_ResetOutputPin(Pins->ClkGpio, Pins->ClkPin);
   }
 }
 
 static void
-TM1638_StbWrite(uint8_t Level)
+TM1638_StbWrite(void *Context, uint8_t Level)
 {
+  TM1638_Platform_Pins_t *Pins = Context;
+
   if(Level)
   {
-    LL_GPIO_SetOutputPin(TM1638_STB_GPIO, TM1638_STB_PIN);
+    LL_GPIO_SetOutputPin(Pins->StbGpio, Pins->StbPin);
   }
   else
   {
-    LL_GPIO_ResetOutputPin(TM1638_STB_GPIO, TM1638_STB_PIN);
+    LL_GPIO_ResetOutputPin(Pins->StbGpio, Pins->StbPin);
   }
 }
 
 static void
-TM1638_DelayUs(uint8_t Delay)
+TM1638_DelayUs(void *Context, uint8_t Delay)
 {
+  (void)Context;
+
   // TODO: Implement a proper delay function. This one is not accurate.
   for (uint32_t DelayCounter = 0; DelayCounter < 100 * Delay; DelayCounter++)
     DelayCounter = DelayCounter;
 }
 
+#if (TM1638_USE_BYTE_IO)
+static void
+TM1638_WriteByte(void *Context, uint8_t Data, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  for (uint8_t i = 0; i < 8; ++i, Data >>= 1)
+  {
+    LL_GPIO_ResetOutputPin(Pins->ClkGpio, Pins->ClkPin);
+    if (Data & 0x01)
+      LL_GPIO_SetOutputPin(Pins->DioGpio, Pins->DioPin);
+    else
+      LL_GPIO_ResetOutputPin(Pins->DioGpio, Pins->DioPin);
+    if (Delay->ClkLow)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkLow);
+    LL_GPIO_SetOutputPin(Pins->ClkGpio, Pins->ClkPin);
+    if (Delay->ClkHigh)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkHigh);
+  }
+}
+
+static uint8_t
+TM1638_ReadByte(void *Context, const TM1638_Timing_t *Delay)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+  uint8_t Data = 0;
+
+  for (uint8_t i = 0; i < 8; ++i)
+  {
+    LL_GPIO_ResetOutputPin(Pins->ClkGpio, Pins->ClkPin);
+    if (Delay->ClkLow)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkLow);
+    LL_GPIO_SetOutputPin(Pins->ClkGpio, Pins->ClkPin);
+    if (LL_GPIO_ReadInputPort(Pins->DioGpio) & TM1638_PIN_MASK(Pins->DioPin))
+      Data |= (1 << i);
+    if (Delay->ClkHigh)
+      TM1638_DelayUs(Context, (uint8_t)Delay->ClkHigh);
+  }
+
+  return Data;
+}
+#endif
+
+#if (TM1638_CONFIG_GROUP)
+static void
+TM1638_PortWrite(void *Context, uint32_t SetMask, uint32_t ClearMask)
+{
+  TM1638_Platform_Pins_t *Pins = Context;
+
+  Pins->ClkGpio->BSRR = SetMask | (ClearMask << 16);
+}
+#endif
+
 
 
 /**
@@ -154,12 +252,29 @@ TM1638_DelayUs(uint8_t Delay)
  
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
 void
 TM1638_Platform_Init(TM1638_Handler_t *Handler)
 {
+  TM1638_Platform_InitPins(Handler, &TM1638_DefaultPins);
+}
+
+
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins)
+{
+  Handler->Context = Pins;
   Handler->PlatformInit = TM1638_PlatformInit;
   Handler->PlatformDeInit = TM1638_PlatformDeInit;
   Handler->DioConfigOut = TM1638_DioConfigOut;
@@ -169,4 +284,62 @@ TM1638_Platform_Init(TM1638_Handler_t *Handler)
   Handler->ClkWrite = TM1638_ClkWrite;
   Handler->StbWrite = TM1638_StbWrite;
   Handler->DelayUs = TM1638_DelayUs;
+#if (TM1638_USE_BYTE_IO)
+  Handler->WriteByte = TM1638_WriteByte;
+  Handler->ReadByte = TM1638_ReadByte;
+#endif
+}
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group)
+{
+  TM1638_Platform_Pins_t *First = Group->Chips[0].Context;
+  TM1638_Platform_Pins_t *Pins, *Other;
+
+  // Chips on one DIO pin get the same mask, the others a mask of their own
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = 1UL << i;
+    for (uint8_t j = 0; j < i; j++)
+    {
+      Other = Group->Chips[j].Context;
+      if (Other->DioGpio == Pins->DioGpio && Other->DioPin == Pins->DioPin)
+      {
+        Group->DioMask[i] = Group->DioMask[j];
+        break;
+      }
+    }
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    if (Pins->ClkGpio != First->ClkGpio || Pins->DioGpio != First->ClkGpio ||
+        Pins->StbGpio != First->ClkGpio || Pins->ClkPin != First->ClkPin)
+      return;
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    Pins = Group->Chips[i].Context;
+    Group->DioMask[i] = TM1638_PIN_MASK(Pins->DioPin);
+    Group->StbMask |= TM1638_PIN_MASK(Pins->StbPin);
+  }
+
+  Group->Context = First;
+  Group->ClkMask = TM1638_PIN_MASK(First->ClkPin);
+  Group->PortWrite = TM1638_PortWrite;
 }
+#endif
@@ -53,6 +53,82 @@ extern "C" {
 #define TM1638_STB_GPIO     GPIOA
 #define TM1638_STB_PIN      LL_GPIO_PIN_3
 
+/**
+ * @brief  Install whole-byte callbacks for faster bit-banging
+ * @note   They apply the timing profile of TM1638_SetTiming to each bit but
+ *         save the per-bit GPIO callback calls of the driver.
+ */
+#define TM1638_USE_BYTE_IO  1
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+#include "main.h"
+
+/**
+ * @brief  Pins descriptor of a TM1638 (used as handler Context)
+ */
+typedef struct TM1638_Platform_Pins_s
+{
+  GPIO_TypeDef *ClkGpio;
+  uint32_t ClkPin;
+  GPIO_TypeDef *DioGpio;
+  uint32_t DioPin;
+  GPIO_TypeDef *StbGpio;
+  uint32_t StbPin;
+} TM1638_Platform_Pins_t;
+
+
+/* Static Pin Functions ---------------------------------------------------------*/
+#if (TM1638_CONFIG_STATIC_PINS)
+#include "main.h"
+
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  LL_GPIO_SetPinMode(TM1638_DIO_GPIO, TM1638_DIO_PIN, LL_GPIO_MODE_OUTPUT);
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  LL_GPIO_SetPinPull(TM1638_DIO_GPIO, TM1638_DIO_PIN, LL_GPIO_PULL_UP);
+  LL_GPIO_SetPinMode(TM1638_DIO_GPIO, TM1638_DIO_PIN, LL_GPIO_MODE_INPUT);
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  if (Level)
+    LL_GPIO_SetOutputPin(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+  else
+    LL_GPIO_ResetOutputPin(TM1638_DIO_GPIO, TM1638_DIO_PIN);
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return (LL_GPIO_ReadInputPort(TM1638_DIO_GPIO) & TM1638_DIO_PIN) ? 1 : 0;
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  if (Level)
+    LL_GPIO_SetOutputPin(TM1638_CLK_GPIO, TM1638_CLK_PIN);
+  else
+    LL_GPIO_ResetOutputPin(TM1638_CLK_GPIO, TM1638_CLK_PIN);
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  if (Level)
+    LL_GPIO_SetOutputPin(TM1638_STB_GPIO, TM1638_STB_PIN);
+  else
+    LL_GPIO_ResetOutputPin(TM1638_STB_GPIO, TM1638_STB_PIN);
+}
+#endif
+
 
 
 /**
@@ -63,6 +139,7 @@ extern "C" {
 
 /**
  * @brief  Initialize platform device to communicate TM1638.
+ * @note   Pins defined in TM1638_platform.h are used.
  * @param  Handler: Pointer to handler
  * @retval None
  */
@@ -70,6 +147,33 @@ void
 TM1638_Platform_Init(TM1638_Handler_t *Handler);
 
 
+/**
+ * @brief  Initialize platform device to communicate TM1638 on given pins.
+ * @note   Pins must remain valid while the handler is used. Several handlers
+ *         can be initialized with different pins.
+ * @param  Handler: Pointer to handler
+ * @param  Pins: Pointer to pins descriptor
+ * @retval None
+ */
+void
+TM1638_Platform_InitPins(TM1638_Handler_t *Handler, TM1638_Platform_Pins_t *Pins);
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Enable single-frame access to a group if all pins are on one port.
+ * @note   Call it after TM1638_GroupInit(). Chips must be initialized by
+ *         TM1638_Platform_Init() or TM1638_Platform_InitPins() and share CLK.
+ *         DIO and STB can be common or separate. Otherwise the group stays
+ *         in pin mode and only learns which chips share DIO.
+ * @param  Group: Pointer to group
+ * @retval None
+ */
+void
+TM1638_Platform_InitGroup(TM1638_Group_t *Group);
+#endif
+
+
 
 #ifdef __cplusplus
 }
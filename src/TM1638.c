@@ -33,6 +33,13 @@
 
 /* Includes ---------------------------------------------------------------------*/
 #include "TM1638.h"
+#include <stddef.h>
+#if (TM1638_CONFIG_STATIC_PINS)
+#include "TM1638_platform.h"
+#endif
+#if defined(__AVR__)
+#include <avr/pgmspace.h>
+#endif
 
 
 /* Private Constants ------------------------------------------------------------*/
@@ -59,53 +66,120 @@
 #define ShowTurnOff   0x00  // 0b00000000
 #define ShowTurnOn    0x08  // 0b00001000
 
+/**
+ * @brief  DIO direction state
+ */
+#define DioDirectionUnknown   0
+#define DioDirectionOut       1
+#define DioDirectionIn        2
+
+/**
+ * @brief  Asynchronous engine phases
+ */
+#define AsyncPhaseFrameStart  0
+#define AsyncPhaseWriteLow    1
+#define AsyncPhaseWriteHigh   2
+#define AsyncPhaseReadStart   3
+#define AsyncPhaseReadLow     4
+#define AsyncPhaseReadHigh    5
+#define AsyncPhaseFrameEnd    6
+
+/**
+ * @brief  Digit encoding
+ */
+#define EncodeRaw   0
+#define EncodeFont  1
+
+
+/* Private Macro ----------------------------------------------------------------*/
+/**
+ * @brief  Constant table access
+ * @note   On AVR fonts and other constant tables are kept in program memory
+ *         and read by LPM.
+ */
+#if defined(__AVR__)
+#define TM1638_FLASH                PROGMEM
+#define TM1638_FLASH_BYTE(T, I)     pgm_read_byte(&(T)[I])
+#define TM1638_FLASH_WORD(T, I)     pgm_read_word(&(T)[I])
+#define TM1638_FLASH_DWORD(T, I)    pgm_read_dword(&(T)[I])
+#else
+#define TM1638_FLASH
+#define TM1638_FLASH_BYTE(T, I)     ((T)[I])
+#define TM1638_FLASH_WORD(T, I)     ((T)[I])
+#define TM1638_FLASH_DWORD(T, I)    ((T)[I])
+#endif
+
+/**
+ * @brief  GPIO access
+ * @note   If 'TM1638_CONFIG_STATIC_PINS' is set, the platform layer provides
+ *         these operations as static inline functions and they are inlined
+ *         into the bit loops instead of being called through the handler.
+ */
+#if (TM1638_CONFIG_STATIC_PINS)
+#define TM1638_DIO_CONFIG_OUT(H)  ((void)(H), TM1638_Static_DioConfigOut())
+#define TM1638_DIO_CONFIG_IN(H)   ((void)(H), TM1638_Static_DioConfigIn())
+#define TM1638_DIO_WRITE(H, L)    ((void)(H), TM1638_Static_DioWrite(L))
+#define TM1638_DIO_READ(H)        ((void)(H), TM1638_Static_DioRead())
+#define TM1638_CLK_WRITE(H, L)    ((void)(H), TM1638_Static_ClkWrite(L))
+#define TM1638_STB_WRITE(H, L)    ((void)(H), TM1638_Static_StbWrite(L))
+#else
+#define TM1638_DIO_CONFIG_OUT(H)  (H)->DioConfigOut((H)->Context)
+#define TM1638_DIO_CONFIG_IN(H)   (H)->DioConfigIn((H)->Context)
+#define TM1638_DIO_WRITE(H, L)    (H)->DioWrite((H)->Context, L)
+#define TM1638_DIO_READ(H)        (H)->DioRead((H)->Context)
+#define TM1638_CLK_WRITE(H, L)    (H)->ClkWrite((H)->Context, L)
+#define TM1638_STB_WRITE(H, L)    (H)->StbWrite((H)->Context, L)
+#endif
+
 
 /* Private variables ------------------------------------------------------------*/
 /**
- * @brief  Convert HEX number to Seven-Segment code
- */
-const uint8_t HexTo7Seg[40] =
-{
-  0x3F, // 0
-  0x06, // 1
-  0x5B, // 2
-  0x4F, // 3
-  0x66, // 4
-  0x6D, // 5
-  0x7D, // 6
-  0x07, // 7
-  0x7F, // 8
-  0x6F, // 9
-  0x77, // A
-  0x7c, // b
-  0x39, // C
-  0x5E, // d
-  0x79, // E
-  0x71, // F
-  0x6F, // g
-  0x3D, // G
-  0x74, // h
-  0x76, // H
-  0x05, // i
-  0x06, // I
-  0x0D, // j
-  0x30, // l
-  0x38, // L
-  0x54, // n
-  0x37, // N
-  0x5C, // o
-  0x3F, // O
-  0x73, // P
-  0x67, // q
-  0x50, // r
-  0x6D, // S
-  0x78, // t
-  0x1C, // u
-  0x3E, // U
-  0x66, // y
-  0x08, // _
-  0x40, // -
-  0x01  // Overscore
+ * @brief  Default bus timing (nanoseconds)
+ */
+static const TM1638_Timing_t TM1638_DefaultTiming =
+{
+  .ClkLow = 1000,
+  .ClkHigh = 1000,
+  .ReadWait = 5000,
+  .ByteGap = 2000
+};
+
+/**
+ * @brief  Default font, ASCII to 7-segment code
+ * @note   Codes 0x00 to 0x0F are hex digits, so digit values and ASCII
+ *         characters share one table. Bit 7 of the data is the decimal point.
+ */
+static const uint8_t TM1638_DefaultFont[128] TM1638_FLASH =
+{
+  0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, // 0x00-0x07: hex digits
+  0x7F, 0x6F, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, // 0x08-0x0F: hex digits
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x10-0x17: not used
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 0x18-0x1F: not used
+  0x00, 0x82, 0x22, 0x00, 0x00, 0x00, 0x00, 0x02, //   ! " # $ % & '
+  0x39, 0x0F, 0x00, 0x00, 0x0C, 0x40, 0x80, 0x52, // ( ) * + , - . /
+  0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, // 0 1 2 3 4 5 6 7
+  0x7F, 0x6F, 0x00, 0x00, 0x58, 0x48, 0x4C, 0x53, // 8 9 : ; < = > ?
+  0x00, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D, // @ A B C D E F G
+  0x76, 0x06, 0x0D, 0x75, 0x38, 0x37, 0x37, 0x3F, // H I J K L M N O
+  0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x3E, 0x3E, // P Q R S T U V W
+  0x76, 0x66, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08, // X Y Z [ \ ] ^ _
+  0x20, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x6F, // ` a b c d e f g
+  0x74, 0x05, 0x0D, 0x75, 0x30, 0x54, 0x54, 0x5C, // h i j k l m n o
+  0x73, 0x67, 0x50, 0x6D, 0x78, 0x1C, 0x1C, 0x1C, // p q r s t u v w
+  0x76, 0x66, 0x5B, 0x39, 0x30, 0x0F, 0x01, 0x00  // x y z { | } ~ .
+};
+
+/**
+ * @brief  Powers of ten for decimal conversion
+ */
+static const uint32_t TM1638_Pow10_32[6] TM1638_FLASH =
+{
+  1000000000, 100000000, 10000000, 1000000, 100000, 10000
+};
+
+static const uint16_t TM1638_Pow10_16[4] TM1638_FLASH =
+{
+  10000, 1000, 100, 10
 };
 
 
@@ -116,16 +190,68 @@ const uint8_t HexTo7Seg[40] =
  ==================================================================================
  */
 
+static inline void
+TM1638_Delay(TM1638_Handler_t *Handler, uint16_t Delay)
+{
+  if (Delay == 0)
+    return;
+
+  if (Handler->DelayCycles)
+    Handler->DelayCycles(Handler->Context, Delay);
+  else
+    Handler->DelayUs(Handler->Context, (uint8_t)Delay);
+}
+
+static uint16_t
+TM1638_NsToDelay(TM1638_Handler_t *Handler, uint16_t Ns)
+{
+  uint32_t Delay;
+
+  if (Handler->DelayCycles)
+    Delay = ((uint32_t)Ns * Handler->CpuFreqMHz + 999) / 1000;
+  else
+    Delay = ((uint32_t)Ns + 999) / 1000;
+
+  return (Delay > 0xFFFF) ? 0xFFFF : (uint16_t)Delay;
+}
+
 static inline void
 TM1638_StartComunication(TM1638_Handler_t *Handler)
 {
-  Handler->StbWrite(0);
+  TM1638_STB_WRITE(Handler, 0);
+}
+
+static inline void
+TM1638_DioOut(TM1638_Handler_t *Handler)
+{
+  if (Handler->DioDirection != DioDirectionOut)
+  {
+    TM1638_DIO_CONFIG_OUT(Handler);
+    Handler->DioDirection = DioDirectionOut;
+  }
+}
+
+static inline void
+TM1638_DioIn(TM1638_Handler_t *Handler)
+{
+  if (Handler->DioDirection != DioDirectionIn)
+  {
+    TM1638_DIO_CONFIG_IN(Handler);
+    Handler->DioDirection = DioDirectionIn;
+  }
 }
 
+/**
+ * @brief  End a frame
+ * @note   DIO is left as output between frames, so the direction cache of
+ *         each handler on a common DIO line matches the pin and only reads
+ *         pay for switching it.
+ */
 static inline void
 TM1638_StopComunication(TM1638_Handler_t *Handler)
 {
-  Handler->StbWrite(1);
+  TM1638_STB_WRITE(Handler, 1);
+  TM1638_DioOut(Handler);
 }
 
 static void
@@ -134,17 +260,26 @@ TM1638_WriteBytes(TM1638_Handler_t *Handler,
 {
   uint8_t i, j, Buff;
 
-  Handler->DioConfigOut();
+  TM1638_DioOut(Handler);
+
+#if (TM1638_CONFIG_STATIC_PINS == 0)
+  if (Handler->WriteByte)
+  {
+    for (j = 0; j < NumOfBytes; j++)
+      Handler->WriteByte(Handler->Context, Data[j], &Handler->Delay);
+    return;
+  }
+#endif
 
   for (j = 0; j < NumOfBytes; j++)
   {
     for (i = 0, Buff = Data[j]; i < 8; ++i, Buff >>= 1)
     {
-      Handler->ClkWrite(0);
-      Handler->DelayUs(1);
-      Handler->DioWrite(Buff & 0x01);
-      Handler->ClkWrite(1);
-      Handler->DelayUs(1);
+      TM1638_CLK_WRITE(Handler, 0);
+      TM1638_Delay(Handler, Handler->Delay.ClkLow);
+      TM1638_DIO_WRITE(Handler, Buff & 0x01);
+      TM1638_CLK_WRITE(Handler, 1);
+      TM1638_Delay(Handler, Handler->Delay.ClkHigh);
     }
   }
 }
@@ -155,576 +290,2577 @@ TM1638_ReadBytes(TM1638_Handler_t *Handler,
 {
   uint8_t i, j, Buff;
 
-  Handler->DioConfigIn();
+  TM1638_DioIn(Handler);
 
-  Handler->DelayUs(5);
+  TM1638_Delay(Handler, Handler->Delay.ReadWait);
 
   for (j = 0; j < NumOfBytes; j++)
   {
+#if (TM1638_CONFIG_STATIC_PINS == 0)
+    if (Handler->ReadByte)
+    {
+      Data[j] = Handler->ReadByte(Handler->Context, &Handler->Delay);
+      TM1638_Delay(Handler, Handler->Delay.ByteGap);
+      continue;
+    }
+#endif
+
     for (i = 0, Buff = 0; i < 8; i++)
     {
-      Handler->ClkWrite(0);
-      Handler->DelayUs(1);
-      Handler->ClkWrite(1);
-      Buff |= (Handler->DioRead() << i);
-      Handler->DelayUs(1);
+      TM1638_CLK_WRITE(Handler, 0);
+      TM1638_Delay(Handler, Handler->Delay.ClkLow);
+      TM1638_CLK_WRITE(Handler, 1);
+      Buff |= (TM1638_DIO_READ(Handler) << i);
+      TM1638_Delay(Handler, Handler->Delay.ClkHigh);
     }
 
     Data[j] = Buff;
-    Handler->DelayUs(2);
+    TM1638_Delay(Handler, Handler->Delay.ByteGap);
   }
 }
 
 static void
-TM1638_SetMultipleDisplayRegister(TM1638_Handler_t *Handler,
-                                  const uint8_t *DigitData,
-                                  uint8_t StartAddr, uint8_t Count)
+TM1638_Transfer(TM1638_Handler_t *Handler, uint8_t Command,
+                const uint8_t *TxData, uint8_t TxLen,
+                uint8_t *RxData, uint8_t RxLen)
 {
-  uint8_t Data = DataInstructionSet | WriteDataToRegister |
-                 AutoAddressAdd | NormalMode;
-
-  TM1638_StartComunication(Handler);
-  TM1638_WriteBytes(Handler, &Data, 1);
-  TM1638_StopComunication(Handler);
-
-  Data = AddressInstructionSet | StartAddr;
+  if (Handler->Transfer)
+  {
+    Handler->Transfer(Handler->Context, Command, TxData, TxLen,
+                      RxData, RxLen, &Handler->Delay);
+    return;
+  }
 
   TM1638_StartComunication(Handler);
-  TM1638_WriteBytes(Handler, &Data, 1);
-  TM1638_WriteBytes(Handler, DigitData, Count);
+  TM1638_WriteBytes(Handler, &Command, 1);
+  if (TxLen)
+    TM1638_WriteBytes(Handler, TxData, TxLen);
+  if (RxLen)
+    TM1638_ReadBytes(Handler, RxData, RxLen);
   TM1638_StopComunication(Handler);
 }
 
+#if (TM1638_CONFIG_ASYNC)
+/**
+ * @brief  Append a frame to the asynchronous job
+ * @note   Frame header: bits 0-4 number of bytes to write (with command),
+ *         bits 5-7 number of bytes to read.
+ */
 static void
-TM1638_ScanKeyRegs(TM1638_Handler_t *Handler, uint8_t *KeyRegs)
+TM1638_QueueFrame(TM1638_Handler_t *Handler, uint8_t Command,
+                  const uint8_t *Data, uint8_t Len, uint8_t ReadLen)
 {
-  uint8_t Data = DataInstructionSet | ReadKeyScanData |
-                 AutoAddressAdd | NormalMode;
+  TM1638_Async_t *Async = &Handler->Async;
 
-  TM1638_StartComunication(Handler);
-  TM1638_WriteBytes(Handler, &Data, 1);
-  TM1638_ReadBytes(Handler, KeyRegs, 4);
-  TM1638_StopComunication(Handler);
+  Async->Job[Async->Length++] = (uint8_t)((Len + 1) | (ReadLen << 5));
+  Async->Job[Async->Length++] = Command;
+  for (uint8_t i = 0; i < Len; i++)
+    Async->Job[Async->Length++] = Data[i];
 }
 
+static void
+TM1638_AsyncStart(TM1638_Handler_t *Handler, uint8_t Type)
+{
+  Handler->Async.Index = 0;
+  Handler->Async.Phase = AsyncPhaseFrameStart;
+  Handler->Async.Type = Type;
+  Handler->Async.Busy = 1;
 
+  if (Handler->TimerStart)
+    Handler->TimerStart(Handler->Context);
+}
 
 /**
- ==================================================================================
-                           ##### Common Functions #####                            
- ==================================================================================
+ * @brief  Advance the asynchronous job by one step (a clock half-period)
+ * @retval Delay to wait before the next step (in delay units)
  */
+static uint16_t
+TM1638_AsyncStep(TM1638_Handler_t *Handler)
+{
+  TM1638_Async_t *Async = &Handler->Async;
+  uint8_t Header;
+
+  switch (Async->Phase)
+  {
+  case AsyncPhaseFrameStart:
+    if (Async->Index >= Async->Length)
+    {
+      Async->Busy = 0;
+      if (Handler->TimerStop)
+        Handler->TimerStop(Handler->Context);
+      if (Handler->AsyncDone)
+        Handler->AsyncDone(Handler, Async->Type);
+      return 0;
+    }
+
+    Header = Async->Job[Async->Index++];
+    Async->Write = Header & 0x1F;
+    Async->Read = Header >> 5;
+    Async->Received = 0;
+
+    if (Handler->Transfer)
+    {
+      Handler->Transfer(Handler->Context, Async->Job[Async->Index],
+                        &Async->Job[Async->Index + 1],
+                        Async->Write - 1, Async->KeyRegs, Async->Read,
+                        &Handler->Delay);
+      Async->Index += Async->Write;
+      return 0;
+    }
+
+    TM1638_DioOut(Handler);
+    TM1638_StartComunication(Handler);
+    Async->Data = Async->Job[Async->Index++];
+    Async->Write--;
+    Async->Bit = 0;
+    Async->Phase = AsyncPhaseWriteLow;
+    return 0;
+
+  case AsyncPhaseWriteLow:
+    TM1638_CLK_WRITE(Handler, 0);
+    TM1638_DIO_WRITE(Handler, Async->Data & 0x01);
+    Async->Phase = AsyncPhaseWriteHigh;
+    return Handler->Delay.ClkLow;
+
+  case AsyncPhaseWriteHigh:
+    TM1638_CLK_WRITE(Handler, 1);
+    Async->Data >>= 1;
+    Async->Phase = AsyncPhaseWriteLow;
+    if (++Async->Bit == 8)
+    {
+      Async->Bit = 0;
+      if (Async->Write)
+      {
+        Async->Data = Async->Job[Async->Index++];
+        Async->Write--;
+      }
+      else
+      {
+        Async->Phase = Async->Read ? AsyncPhaseReadStart : AsyncPhaseFrameEnd;
+      }
+    }
+    return Handler->Delay.ClkHigh;
+
+  case AsyncPhaseReadStart:
+    TM1638_DioIn(Handler);
+    Async->Data = 0;
+    Async->Phase = AsyncPhaseReadLow;
+    return Handler->Delay.ReadWait;
+
+  case AsyncPhaseReadLow:
+    TM1638_CLK_WRITE(Handler, 0);
+    Async->Phase = AsyncPhaseReadHigh;
+    return Handler->Delay.ClkLow;
+
+  case AsyncPhaseReadHigh:
+    TM1638_CLK_WRITE(Handler, 1);
+    Async->Data |= (TM1638_DIO_READ(Handler) << Async->Bit);
+    Async->Phase = AsyncPhaseReadLow;
+    if (++Async->Bit < 8)
+      return Handler->Delay.ClkHigh;
+
+    Async->KeyRegs[Async->Received++] = Async->Data;
+    Async->Data = 0;
+    Async->Bit = 0;
+    if (--Async->Read == 0)
+      Async->Phase = AsyncPhaseFrameEnd;
+    return Handler->Delay.ByteGap;
+
+  case AsyncPhaseFrameEnd:
+  default:
+    TM1638_StopComunication(Handler);
+    Async->Phase = AsyncPhaseFrameStart;
+    return Handler->Delay.ClkHigh;
+  }
+}
+#endif
 
 /**
- * @brief  Initialize TM1638.
- * @param  Handler: Pointer to handler
- * @param  Type: Determine the type of display
- *         - TM1638DisplayTypeComCathode: Common-Cathode
- *         - TM1638DisplayTypeComAnode:   Common-Anode
- * @note   If 'TM1638_CONFIG_SUPPORT_COM_ANODE' switch is set to 0, the 'Type'
- *         argument will be ignored 
- *         
- * @retval TM1638_Result_t
- *         - TM1638_OK: Operation was successful.
+ * @brief  Plan register frames for a dirty mask
+ * @note   Every new frame costs its address byte plus the STB overhead, while
+ *         bridging a gap costs 8 clocks per clean register. Gaps are bridged
+ *         whenever that is not more expensive, so the chosen runs need the
+ *         fewest clock edges and STB toggles. Decisions for different gaps are
+ *         independent, which makes this greedy pass optimal.
  */
-TM1638_Result_t
-TM1638_Init(TM1638_Handler_t *Handler, uint8_t Type)
+static uint16_t
+TM1638_PlanRuns(uint16_t Mask)
 {
-  Handler->DisplayType = TM1638DisplayTypeComCathode;
+  const uint8_t MaxGap = (8 + TM1638_CONFIG_FRAME_OVERHEAD_BITS) / 8;
+  uint16_t Planned = Mask;
+  uint8_t Gap = 0;
+  uint8_t Seen = 0;
 
-#if TM1638_CONFIG_SUPPORT_COM_ANODE
   for (uint8_t i = 0; i < 16; i++)
   {
-    Handler->DisplayRegister[i] = 0;
+    if (Mask & (1U << i))
+    {
+      if (Seen && Gap && Gap <= MaxGap)
+        Planned |= (uint16_t)(((1U << Gap) - 1) << (i - Gap));
+      Seen = 1;
+      Gap = 0;
+    }
+    else
+    {
+      Gap++;
+    }
   }
-  if (Type == TM1638DisplayTypeComCathode)
-    Handler->DisplayType = TM1638DisplayTypeComCathode;
-  else
-    Handler->DisplayType = TM1638DisplayTypeComAnode;
-#endif
 
-  Handler->PlatformInit();
-  return TM1638_OK;
+  return Planned;
+}
+
+static inline void
+TM1638_WriteFrame(TM1638_Handler_t *Handler, uint8_t Queue, uint8_t Command,
+                  const uint8_t *Data, uint8_t Len)
+{
+#if (TM1638_CONFIG_ASYNC)
+  if (Queue)
+  {
+    TM1638_QueueFrame(Handler, Command, Data, Len, 0);
+    return;
+  }
+#else
+  (void)Queue;
+#endif
+  TM1638_Transfer(Handler, Command, Data, Len, NULL, 0);
 }
 
 /**
- * @brief  De-Initialize TM1638.
- * @param  Handler: Pointer to handler
- * @retval TM1638_Result_t
- *         - TM1638_OK: Operation was successful.
+ * @brief  Send (or queue if Queue is set) register runs of a mask
  */
-TM1638_Result_t
-TM1638_DeInit(TM1638_Handler_t *Handler)
+static void
+TM1638_WriteRegisterRuns(TM1638_Handler_t *Handler, uint8_t Queue,
+                         const uint8_t *Register, uint16_t Mask)
 {
-  Handler->PlatformDeInit();
-  return TM1638_OK;
-}
+  uint8_t Start, End;
 
+  if (Mask == 0)
+    return;
 
+  Mask = TM1638_PlanRuns(Mask);
 
-/**
- ==================================================================================
-                        ##### Public Display Functions #####                       
- ==================================================================================
- */
+  TM1638_WriteFrame(Handler, Queue,
+                    DataInstructionSet | WriteDataToRegister |
+                    AutoAddressAdd | NormalMode,
+                    NULL, 0);
+
+  for (Start = 0; Start < 16; Start = End)
+  {
+    if (!(Mask & (1U << Start)))
+    {
+      End = Start + 1;
+      continue;
+    }
+
+    for (End = Start + 1; End < 16 && (Mask & (1U << End)); End++);
+
+    TM1638_WriteFrame(Handler, Queue, AddressInstructionSet | Start,
+                      &Register[Start], End - Start);
+  }
+}
 
 /**
- * @brief  Config display parameters
- * @param  Handler: Pointer to handler
- * @param  Brightness: Set brightness level
- *         - 0: Display pulse width is set as 1/16
- *         - 1: Display pulse width is set as 2/16
- *         - 2: Display pulse width is set as 4/16
- *         - 3: Display pulse width is set as 10/16
- *         - 4: Display pulse width is set as 11/16
- *         - 5: Display pulse width is set as 12/16
- *         - 6: Display pulse width is set as 13/16
- *         - 7: Display pulse width is set as 14/16
- * 
- * @param  DisplayState: Set display ON or OFF
- *         - TM1638DisplayStateOFF: Set display state OFF
- *         - TM1638DisplayStateON: Set display state ON
- * 
- * @retval TM1638_Result_t
- *         - TM1638_OK: Operation was successful
+ * @brief  Register image that digit functions draw into
  */
-TM1638_Result_t
-TM1638_ConfigDisplay(TM1638_Handler_t *Handler,
-                     uint8_t Brightness, uint8_t DisplayState)
+static inline uint8_t *
+TM1638_Image(TM1638_Handler_t *Handler)
 {
-  uint8_t Data = DisplayControlInstructionSet;
-  Data |= Brightness & 0x07;
-  Data |= (DisplayState) ? (ShowTurnOn) : (ShowTurnOff);
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  return Handler->BackRegister[Handler->BackPage];
+#else
+  return Handler->DisplayRegister;
+#endif
+}
 
-  TM1638_StartComunication(Handler);
-  TM1638_WriteBytes(Handler, &Data, 1);
-  TM1638_StopComunication(Handler);
+static inline void
+TM1638_UpdateRegister(TM1638_Handler_t *Handler, uint8_t Addr, uint8_t Data)
+{
+  if (Handler->DisplayRegister[Addr] == Data)
+  {
+    Handler->SavedBytes++;
+    return;
+  }
 
-  return TM1638_OK;
+  Handler->DisplayRegister[Addr] = Data;
+  Handler->DirtyMask |= (1U << Addr);
 }
 
+static inline void
+TM1638_SetRegister(TM1638_Handler_t *Handler, uint8_t Addr, uint8_t Data)
+{
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  Handler->BackRegister[Handler->BackPage][Addr] = Data;
+#else
+  TM1638_UpdateRegister(Handler, Addr, Data);
+#endif
+}
 
 /**
- * @brief  Set data to single digit in 7-segment format
- * @param  Handler: Pointer to handler
- * @param  DigitData: Digit data
- * @param  DigitPos: Digit position
- *         - 0: Seg1
- *         - 1: Seg2
- *         - .
- *         - .
- *         - .
- * 
- * @retval TM1638_Result_t
- *         - TM1638_OK: Operation was successful
+ * @brief  Write a register into the shown image, bypassing the back buffer
+ * @note   Both pages of the double buffer are updated too, so neither a
+ *         pending nor a later TM1638_SwapBuffers() reverts the register.
  */
-TM1638_Result_t
-TM1638_SetSingleDigit(TM1638_Handler_t *Handler,
-                      uint8_t DigitData, uint8_t DigitPos)
-{ 
-  if (Handler->DisplayType == TM1638DisplayTypeComCathode)
-    TM1638_SetMultipleDisplayRegister(Handler, &DigitData, DigitPos, 1);
-#if (TM1638_CONFIG_SUPPORT_COM_ANODE)
-  else
-    TM1638_SetMultipleDigit(Handler, &DigitData, DigitPos, 1);
+static inline void
+TM1638_SetShownRegister(TM1638_Handler_t *Handler, uint8_t Addr, uint8_t Data)
+{
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  Handler->BackRegister[0][Addr] = Data;
+  Handler->BackRegister[1][Addr] = Data;
 #endif
-  return TM1638_OK;
+  TM1638_UpdateRegister(Handler, Addr, Data);
 }
 
-
 /**
- * @brief  Set data to multiple digits in 7-segment format
- * @param  Handler: Pointer to handler
- * @param  DigitData: Array to Digits data
- * @param  StartAddr: First digit position
- *         - 0: Seg1
- *         - 1: Seg2
- *         - .
- *         - .
- *         - .
- * 
- * @param  Count: Number of segments to write data
- * @retval TM1638_Result_t
- *         - TM1638_OK: Operation was successful
+ * @brief  Get and clear the mask of registers to be sent
  */
-TM1638_Result_t
-TM1638_SetMultipleDigit(TM1638_Handler_t *Handler, const uint8_t *DigitData,
-                        uint8_t StartAddr, uint8_t Count)
+static uint16_t
+TM1638_TakeDirty(TM1638_Handler_t *Handler)
 {
-  uint8_t Shift = 0;
-  uint8_t DigitDataBuff = 0;
-  uint8_t i = 0, j = 0;
+  uint16_t DirtyMask;
 
-  if (Handler->DisplayType == TM1638DisplayTypeComCathode)
-    TM1638_SetMultipleDisplayRegister(Handler, DigitData, StartAddr, Count);
-#if (TM1638_CONFIG_SUPPORT_COM_ANODE)
-  else
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  if (Handler->SwapPending)
   {
-    for (j = 0; j < Count; j++)
-    {
-      DigitDataBuff = DigitData[j];
+    const uint8_t *Front = Handler->BackRegister[Handler->BackPage ^ 1];
 
-      if ((j + StartAddr) >= 0 && (j + StartAddr) <= 7)
-      {
-        Shift = j + StartAddr;
-        i = 0;
-      }
-      else if ((j + StartAddr) == 8 || (j + StartAddr) == 9)
-      {
-        Shift = (j + StartAddr) - 8;
-        i = 1;
-      }
-      else
-      {
-        i = 16;
-      }
+    for (uint8_t i = 0; i < 16; i++)
+      TM1638_UpdateRegister(Handler, i, Front[i]);
+    Handler->SwapPending = 0;
+  }
+#endif
+
+  DirtyMask = Handler->DirtyMask;
+  Handler->DirtyMask = 0;
 
-      for (; i < 16; i += 2, DigitDataBuff >>= 1)
+#if (TM1638_CONFIG_DIMMING)
+  {
+    const uint8_t *Mask = Handler->DimMask[Handler->DimStep];
+    uint8_t Data;
+
+    // Registers are sent if their dimmed value differs from the chip
+    for (uint8_t i = 0; i < 16; i++)
+    {
+      Data = Handler->DisplayRegister[i] & Mask[i];
+      if (Data != Handler->DimRegister[i])
       {
-        if (DigitDataBuff & 0x01)
-          Handler->DisplayRegister[i] |= (1 << Shift);
-        else
-          Handler->DisplayRegister[i] &= ~(1 << Shift);
+        Handler->DimRegister[i] = Data;
+        DirtyMask |= (1U << i);
       }
     }
-    TM1638_SetMultipleDisplayRegister(Handler, Handler->DisplayRegister, 0, 16);
   }
 #endif
 
+  return DirtyMask;
+}
+
+/**
+ * @brief  Registers to be sent to TM1638
+ */
+static inline const uint8_t *
+TM1638_Output(TM1638_Handler_t *Handler)
+{
+#if (TM1638_CONFIG_DIMMING)
+  return Handler->DimRegister;
+#else
+  return Handler->DisplayRegister;
+#endif
+}
+
+static inline TM1638_Result_t
+TM1638_AutoFlush(TM1638_Handler_t *Handler)
+{
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  // Back buffer is published by TM1638_SwapBuffers()
+  (void)Handler;
+#else
+  if (Handler->AutoFlush)
+    return TM1638_Flush(Handler);
+#endif
+  return TM1638_OK;
+}
+
+/**
+ * @brief  Convert a digit to 7-segment format (EncodeRaw: keep raw segments)
+ */
+static inline uint8_t
+TM1638_Encode(TM1638_Handler_t *Handler, uint8_t Encode, uint8_t Data)
+{
+  if (!Encode)
+    return Data;
+  return TM1638_FLASH_BYTE(Handler->Font, Data & 0x7F) | (Data & 0x80);
+}
+
+#if (TM1638_CONFIG_SUPPORT_COM_ANODE)
+/**
+ * @brief  Transpose an 8x8 bit matrix in place
+ * @note   Bit c of Matrix[r] is moved to bit r of Matrix[c].
+ */
+static void
+TM1638_Transpose8(uint8_t *Matrix)
+{
+  uint32_t Lo, Hi, t;
+
+  Lo = (uint32_t)Matrix[0] | ((uint32_t)Matrix[1] << 8) |
+       ((uint32_t)Matrix[2] << 16) | ((uint32_t)Matrix[3] << 24);
+  Hi = (uint32_t)Matrix[4] | ((uint32_t)Matrix[5] << 8) |
+       ((uint32_t)Matrix[6] << 16) | ((uint32_t)Matrix[7] << 24);
+
+  // Swap 1x1 blocks inside 2x2 blocks
+  t = (Lo ^ (Lo >> 7)) & 0x00AA00AA;
+  Lo ^= t ^ (t << 7);
+  t = (Hi ^ (Hi >> 7)) & 0x00AA00AA;
+  Hi ^= t ^ (t << 7);
+
+  // Swap 2x2 blocks inside 4x4 blocks
+  t = (Lo ^ (Lo >> 14)) & 0x0000CCCC;
+  Lo ^= t ^ (t << 14);
+  t = (Hi ^ (Hi >> 14)) & 0x0000CCCC;
+  Hi ^= t ^ (t << 14);
+
+  // Swap 4x4 blocks
+  t = (Lo ^ (Hi << 4)) & 0xF0F0F0F0;
+  Lo ^= t;
+  Hi ^= t >> 4;
+
+  Matrix[0] = (uint8_t)Lo;
+  Matrix[1] = (uint8_t)(Lo >> 8);
+  Matrix[2] = (uint8_t)(Lo >> 16);
+  Matrix[3] = (uint8_t)(Lo >> 24);
+  Matrix[4] = (uint8_t)Hi;
+  Matrix[5] = (uint8_t)(Hi >> 8);
+  Matrix[6] = (uint8_t)(Hi >> 16);
+  Matrix[7] = (uint8_t)(Hi >> 24);
+}
+
+/**
+ * @brief  Convert digits to common-anode register layout
+ * @note   Digits must be in range 0 to 9 (checked by TM1638_SetDigits)
+ * @note   Segment b of digit d (0 to 7) is bit d of register 2b, segment b of
+ *         digit 8 or 9 is bit 0 or 1 of register 2b+1. Digits 0 to 7 and
+ *         digits 8 and 9 are converted with one 8x8 bit transpose each.
+ */
+static void
+TM1638_SetAnodeDigits(TM1638_Handler_t *Handler, const uint8_t *DigitData,
+                      uint8_t StartAddr, uint8_t Count, uint8_t Encode)
+{
+  uint8_t *Image = TM1638_Image(Handler);
+  uint8_t Matrix[8];
+  uint8_t End = StartAddr + Count;
+  uint8_t i;
+
+  if (StartAddr < 8)
+  {
+    for (i = 0; i < 8; i++)
+      Matrix[i] = Image[i << 1];
+
+    // Current digits are needed only if some of them are kept
+    if (StartAddr != 0 || End < 8)
+      TM1638_Transpose8(Matrix);
+
+    for (i = StartAddr; i < End && i < 8; i++)
+      Matrix[i] = TM1638_Encode(Handler, Encode, DigitData[i - StartAddr]);
+
+    TM1638_Transpose8(Matrix);
+    for (i = 0; i < 8; i++)
+      TM1638_SetRegister(Handler, i << 1, Matrix[i]);
+  }
+
+  if (End > 8)
+  {
+    for (i = 0; i < 8; i++)
+      Matrix[i] = Image[(i << 1) + 1] & 0x03;
+
+    TM1638_Transpose8(Matrix);
+    for (i = (StartAddr > 8) ? StartAddr : 8; i < End; i++)
+      Matrix[i - 8] = TM1638_Encode(Handler, Encode, DigitData[i - StartAddr]);
+
+    TM1638_Transpose8(Matrix);
+    for (i = 0; i < 8; i++)
+      TM1638_SetRegister(Handler, (i << 1) + 1,
+                         (Image[(i << 1) + 1] & 0xFC) |
+                         Matrix[i]);
+  }
+}
+#endif
+
+/**
+ * @brief  Write digits into the register image without flushing
+ */
+static TM1638_Result_t
+TM1638_SetDigits(TM1638_Handler_t *Handler, const uint8_t *DigitData,
+                 uint8_t StartAddr, uint8_t Count, uint8_t Encode)
+{
+  if (Handler->DisplayType == TM1638DisplayTypeComCathode)
+  {
+    if (StartAddr > 15 || Count > 16 - StartAddr)
+      return TM1638_FAIL;
+
+    for (uint8_t k = 0; k < Count; k++)
+      TM1638_SetRegister(Handler, StartAddr + k,
+                         TM1638_Encode(Handler, Encode, DigitData[k]));
+  }
+#if (TM1638_CONFIG_SUPPORT_COM_ANODE)
+  else
+  {
+    if (StartAddr > 9 || Count > 10 - StartAddr)
+      return TM1638_FAIL;
+
+    TM1638_SetAnodeDigits(Handler, DigitData, StartAddr, Count, Encode);
+  }
+#endif
+
+  return TM1638_OK;
+}
+
+/**
+ * @brief  Convert a number to decimal digits without division
+ * @note   Each digit is found by subtracting its power of ten. Values that
+ *         fit 16 bits skip the 32-bit subtractions.
+ * @retval Number of digits written to Digits (1 to 10), most significant first
+ */
+static uint8_t
+TM1638_ToDecimal(uint32_t Number, uint8_t *Digits)
+{
+  uint8_t Length = 0;
+  uint8_t First = 0;
+  uint8_t i, d;
+  uint32_t Power;
+  uint16_t Power16, Low;
+
+  if (Number > 0xFFFF)
+  {
+    for (i = 0; i < 6; i++)
+    {
+      Power = TM1638_FLASH_DWORD(TM1638_Pow10_32, i);
+      for (d = 0; Number >= Power; d++)
+        Number -= Power;
+      if (d || Length)
+        Digits[Length++] = d;
+    }
+    // Digit of 10000 is already done
+    First = 1;
+  }
+
+  Low = (uint16_t)Number;
+  for (i = First; i < 4; i++)
+  {
+    Power16 = TM1638_FLASH_WORD(TM1638_Pow10_16, i);
+    for (d = 0; Low >= Power16; d++)
+      Low -= Power16;
+    if (d || Length)
+      Digits[Length++] = d;
+  }
+  Digits[Length++] = (uint8_t)Low;
+
+  return Length;
+}
+
+/**
+ * @brief  Convert a number to hexadecimal digits
+ * @retval Number of digits written to Digits (1 to 8), most significant first
+ */
+static uint8_t
+TM1638_ToHex(uint32_t Number, uint8_t *Digits)
+{
+  uint8_t Length = 0;
+  int8_t Shift;
+
+  for (Shift = 28; Shift > 0 && !(Number >> Shift); Shift -= 4);
+  for (; Shift >= 0; Shift -= 4)
+    Digits[Length++] = (Number >> Shift) & 0x0F;
+
+  return Length;
+}
+
+/**
+ * @brief  Write a converted number right-aligned into Count digits
+ * @note   Digits are digit values, most significant first. DecimalPos is the
+ *         number of fraction digits. If the number does not fit, all digits
+ *         show '-'.
+ */
+static TM1638_Result_t
+TM1638_SetNumberDigits(TM1638_Handler_t *Handler, const uint8_t *Digits,
+                       uint8_t Length, uint8_t Negative, uint8_t DecimalPos,
+                       uint8_t StartAddr, uint8_t Count, uint8_t Flags)
+{
+  uint8_t Buffer[16];
+  uint8_t Width = Length;
+  uint8_t i = Count;
+  TM1638_Result_t Result = TM1638_OK;
+
+  if (Count == 0 || Count > 16 || DecimalPos >= Count)
+    return TM1638_FAIL;
+
+  // At least one digit before the decimal point
+  if (Width <= DecimalPos)
+    Width = DecimalPos + 1;
+
+  if (Width + Negative > Count)
+  {
+    for (i = 0; i < Count; i++)
+      Buffer[i] = '-';
+    Result = TM1638_FAIL;
+  }
+  else
+  {
+    if (Flags & TM1638NumberZeroPad)
+      Width = Count - Negative;
+    while (Length)
+      Buffer[--i] = Digits[--Length];
+    while (i > Count - Width)
+      Buffer[--i] = 0;
+    if (Negative)
+      Buffer[--i] = '-';
+    while (i)
+      Buffer[--i] = ' ';
+    if (DecimalPos)
+      Buffer[Count - 1 - DecimalPos] |= TM1638DecimalPoint;
+  }
+
+  if (TM1638_SetDigits(Handler, Buffer, StartAddr, Count,
+                       EncodeFont) != TM1638_OK)
+    return TM1638_FAIL;
+
+  TM1638_AutoFlush(Handler);
+
+  return Result;
+}
+
+/**
+ * @brief  Write digits of a virtual display, one pass over covered chips
+ */
+static TM1638_Result_t
+TM1638_VirtualSetDigits(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                        uint8_t StartDigit, uint8_t Count,
+                        uint8_t Encode)
+{
+  TM1638_Handler_t *Handler;
+  uint8_t Chip = StartDigit / Virtual->DigitsPerChip;
+  uint8_t Pos = StartDigit % Virtual->DigitsPerChip;
+  uint8_t Len, k;
+
+  if ((uint16_t)StartDigit + Count >
+      (uint16_t)Virtual->Count * Virtual->DigitsPerChip)
+    return TM1638_FAIL;
+
+  for (; Count; Count -= Len, DigitData += Len, Chip++, Pos = 0)
+  {
+    Handler = &Virtual->Chips[Chip];
+    Len = Virtual->DigitsPerChip - Pos;
+    if (Len > Count)
+      Len = Count;
+
+    if (Virtual->PositionStep == 1)
+    {
+      if (TM1638_SetDigits(Handler, DigitData, Pos, Len, Encode) != TM1638_OK)
+        return TM1638_FAIL;
+    }
+    else
+    {
+      for (k = 0; k < Len; k++)
+        if (TM1638_SetDigits(Handler, &DigitData[k],
+                             (Pos + k) * Virtual->PositionStep,
+                             1, Encode) != TM1638_OK)
+          return TM1638_FAIL;
+    }
+
+    TM1638_AutoFlush(Handler);
+  }
+
+  return TM1638_OK;
+}
+
+/**
+ * @brief  Write the visible window of a marquee into the register image
+ */
+static TM1638_Result_t
+TM1638_MarqueeDraw(TM1638_Marquee_t *Marquee)
+{
+  TM1638_Handler_t *Handler = Marquee->Handler;
+  uint8_t Blank[16] = {0};
+  uint8_t Len = Marquee->Length - Marquee->Position;
+  TM1638_Result_t Result;
+
+  if (Len >= Marquee->Count)
+    return TM1638_SetDigits(Handler, &Marquee->Buffer[Marquee->Position],
+                            Marquee->StartAddr, Marquee->Count, EncodeRaw);
+
+  Result = TM1638_SetDigits(Handler, &Marquee->Buffer[Marquee->Position],
+                            Marquee->StartAddr, Len, EncodeRaw);
+  if (Result != TM1638_OK)
+    return Result;
+
+  // Window crosses the end of text, short text is followed by blanks
+  return TM1638_SetDigits(Handler,
+                          (Marquee->Length > Marquee->Count) ?
+                          Marquee->Buffer : Blank,
+                          Marquee->StartAddr + Len, Marquee->Count - Len,
+                          EncodeRaw);
+}
+
+/**
+ * @brief  Last window position of a marquee
+ */
+static inline uint8_t
+TM1638_MarqueeLast(TM1638_Marquee_t *Marquee)
+{
+  if (Marquee->Flags & TM1638MarqueeWrap)
+    return Marquee->Length - 1;
+  return Marquee->Length - Marquee->Count;
+}
+
+/**
+ * @brief  Check if a marquee window is at the start or end of text
+ */
+static inline uint8_t
+TM1638_MarqueeAtEnd(TM1638_Marquee_t *Marquee)
+{
+  if (Marquee->Position == 0)
+    return 1;
+  return !(Marquee->Flags & TM1638MarqueeWrap) &&
+         Marquee->Position == TM1638_MarqueeLast(Marquee);
+}
+
+/**
+ * @brief  Write current frame of an animation into the register image
+ */
+static void
+TM1638_AnimationDraw(TM1638_Animation_t *Animation)
+{
+  TM1638_Handler_t *Handler = Animation->Handler;
+  const TM1638_Frame_t *Frame = &Animation->Frames[Animation->Index];
+  uint16_t Duration = TM1638_FLASH_WORD(&Frame->Duration, 0);
+
+  for (uint8_t i = 0; i < 16; i++)
+    if (Animation->Mask & (1U << i))
+      TM1638_SetRegister(Handler, i, TM1638_FLASH_BYTE(Frame->Register, i));
+
+  Animation->Timer = Duration ? Duration - 1 : 0;
+  TM1638_AutoFlush(Handler);
+}
+
+static inline uint8_t
+TM1638_DisplayControlCommand(uint8_t Brightness, uint8_t DisplayState)
+{
+  uint8_t Data = DisplayControlInstructionSet;
+  Data |= Brightness & 0x07;
+  Data |= (DisplayState) ? (ShowTurnOn) : (ShowTurnOff);
+  return Data;
+}
+
+/**
+ * @brief  Fade level (0: off, 1 to 8: brightness 0 to 7) of a display control
+ *         command
+ */
+static inline uint8_t
+TM1638_FadeLevel(uint8_t DisplayControl)
+{
+  return (DisplayControl & ShowTurnOn) ? (DisplayControl & 0x07) + 1 : 0;
+}
+
+/**
+ * @brief  Level of a fade at its current phase
+ */
+static uint8_t
+TM1638_FadeCompute(TM1638_Fade_t *Fade)
+{
+  uint8_t Ease;
+  uint8_t Delta;
+
+  if (Fade->Curve)
+    Ease = TM1638_FLASH_BYTE(Fade->Curve,
+                             ((uint32_t)Fade->Phase *
+                              (Fade->CurveLength - 1)) >> 16);
+  else
+    Ease = Fade->Phase >> 8;
+
+  // Ease 255 is the whole distance (at most 8 levels)
+  if (Fade->To >= Fade->From)
+  {
+    Delta = Fade->To - Fade->From;
+    return Fade->From + (((uint16_t)Delta * Ease + 128) >> 8);
+  }
+
+  Delta = Fade->From - Fade->To;
+  return Fade->From - (((uint16_t)Delta * Ease + 128) >> 8);
+}
+
+/**
+ * @brief  Send display control command of a fade level if the shown level
+ *         differs
+ */
+static void
+TM1638_FadeApply(TM1638_Handler_t *Handler, uint8_t Level)
+{
+  uint8_t Data;
+
+  if (Handler->DisplayControl &&
+      TM1638_FadeLevel(Handler->DisplayControl) == Level)
+    return;
+
+  if (Level)
+    Data = TM1638_DisplayControlCommand(Level - 1, TM1638DisplayStateON);
+  else
+    Data = TM1638_DisplayControlCommand(Handler->DisplayControl,
+                                        TM1638DisplayStateOFF);
+
+  TM1638_Transfer(Handler, Data, NULL, 0, NULL, 0);
+  Handler->DisplayControl = Data;
+}
+
+/**
+ * @brief  Convert key scan data registers to the 24-bit key mask
+ * @note   Bit k and bit k+4 of register r are SEG(2r+1) and SEG(2r+2) of
+ *         line K(3-k). Each line is gathered from the 4 registers at once by
+ *         moving the bits of every pair of registers together.
+ */
+static uint32_t
+TM1638_DecodeKeys(const uint8_t *KeyRegs)
+{
+  uint32_t Regs, Line;
+  uint32_t Keys = 0;
+
+  Regs = (uint32_t)KeyRegs[0] | ((uint32_t)KeyRegs[1] << 8) |
+         ((uint32_t)KeyRegs[2] << 16) | ((uint32_t)KeyRegs[3] << 24);
+
+  // K3, K2 and K1 end up in bits 16-23, 8-15 and 0-7
+  for (uint8_t k = 0; k < 3; k++)
+  {
+    Line = (Regs >> k) & 0x11111111;
+    Line = (Line | (Line >> 3)) & 0x03030303;
+    Line = (Line | (Line >> 6)) & 0x000F000F;
+    Line = (Line | (Line >> 12)) & 0x000000FF;
+    Keys = (Keys << 8) | Line;
+  }
+
+  return Keys;
+}
+
+static void
+TM1638_ScanKeyRegs(TM1638_Handler_t *Handler, uint8_t *KeyRegs)
+{
+  TM1638_Transfer(Handler,
+                  DataInstructionSet | ReadKeyScanData |
+                  AutoAddressAdd | NormalMode,
+                  NULL, 0, KeyRegs, 4);
+}
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ * @brief  Record a register that is sent outside the flush path
+ * @note   Both pages of the double buffer are updated, so neither a pending
+ *         nor a later TM1638_SwapBuffers() reverts the register.
+ */
+static inline void
+TM1638_SetSentRegister(TM1638_Handler_t *Handler, uint8_t Addr, uint8_t Data)
+{
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  Handler->BackRegister[0][Addr] = Data;
+  Handler->BackRegister[1][Addr] = Data;
+#endif
+  Handler->DisplayRegister[Addr] = Data;
+#if (TM1638_CONFIG_DIMMING)
+  Handler->DimRegister[Addr] = Data;
+#endif
+  Handler->DirtyMask &= ~(1U << Addr);
+}
+
+/**
+ * @brief  Set CLK of all chips
+ */
+static void
+TM1638_GroupClkWrite(TM1638_Group_t *Group, uint8_t Level)
+{
+  if (Group->PortWrite)
+  {
+    Group->PortWrite(Group->Context, Level ? Group->ClkMask : 0,
+                     Level ? 0 : Group->ClkMask);
+    return;
+  }
+
+  // Common pins are just written several times
+  for (uint8_t i = 0; i < Group->Count; i++)
+    Group->Chips[i].ClkWrite(Group->Chips[i].Context, Level);
+}
+
+/**
+ * @brief  Set STB of all chips
+ */
+static void
+TM1638_GroupStbWrite(TM1638_Group_t *Group, uint8_t Level)
+{
+  if (Group->PortWrite)
+  {
+    Group->PortWrite(Group->Context, Level ? Group->StbMask : 0,
+                     Level ? 0 : Group->StbMask);
+    return;
+  }
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+    Group->Chips[i].StbWrite(Group->Chips[i].Context, Level);
+}
+
+/**
+ * @brief  Write one byte of each chip in parallel
+ * @note   With PortWrite, every clock edge is a single port write which sets
+ *         DIO of all chips at once. Otherwise DIO of each chip is set by its
+ *         DioWrite while CLK is low.
+ */
+static void
+TM1638_GroupWriteByte(TM1638_Group_t *Group, const uint8_t *Data)
+{
+  TM1638_Handler_t *Timing = &Group->Chips[0];
+  TM1638_Handler_t *Chip;
+  uint32_t Set, Clear;
+  uint8_t i;
+
+  for (uint8_t j = 0; j < 8; j++)
+  {
+    if (Group->PortWrite)
+    {
+      Set = 0;
+      Clear = Group->ClkMask;
+
+      for (i = 0; i < Group->Count; i++)
+      {
+        if ((Data[i] >> j) & 0x01)
+          Set |= Group->DioMask[i];
+        else
+          Clear |= Group->DioMask[i];
+      }
+
+      Group->PortWrite(Group->Context, Set, Clear);
+    }
+    else
+    {
+      TM1638_GroupClkWrite(Group, 0);
+      for (i = 0; i < Group->Count; i++)
+      {
+        Chip = &Group->Chips[i];
+        Chip->DioWrite(Chip->Context, (Data[i] >> j) & 0x01);
+      }
+    }
+
+    TM1638_Delay(Timing, Timing->Delay.ClkLow);
+    TM1638_GroupClkWrite(Group, 1);
+    TM1638_Delay(Timing, Timing->Delay.ClkHigh);
+  }
+}
+
+/**
+ * @brief  Send a frame to all chips: the command and Len registers from Start
+ */
+static void
+TM1638_GroupWriteFrame(TM1638_Group_t *Group, uint8_t Command,
+                       uint8_t Start, uint8_t Len)
+{
+  uint8_t Data[TM1638_CONFIG_GROUP_MAX_CHIPS];
+  uint8_t i;
+
+  TM1638_GroupStbWrite(Group, 0);
+
+  for (i = 0; i < Group->Count; i++)
+    Data[i] = Command;
+  TM1638_GroupWriteByte(Group, Data);
+
+  for (; Len; Len--, Start++)
+  {
+    for (i = 0; i < Group->Count; i++)
+      Data[i] = TM1638_Output(&Group->Chips[i])[Start];
+    TM1638_GroupWriteByte(Group, Data);
+  }
+
+  TM1638_GroupStbWrite(Group, 1);
+}
+
+/**
+ * @brief  Send register runs of a mask to all chips
+ */
+static void
+TM1638_GroupWriteRuns(TM1638_Group_t *Group, uint16_t Mask)
+{
+  uint8_t Start, End;
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+    TM1638_DioOut(&Group->Chips[i]);
+
+  Mask = TM1638_PlanRuns(Mask);
+
+  TM1638_GroupWriteFrame(Group,
+                         DataInstructionSet | WriteDataToRegister |
+                         AutoAddressAdd | NormalMode,
+                         0, 0);
+
+  for (Start = 0; Start < 16; Start = End)
+  {
+    if (!(Mask & (1U << Start)))
+    {
+      End = Start + 1;
+      continue;
+    }
+
+    for (End = Start + 1; End < 16 && (Mask & (1U << End)); End++);
+
+    TM1638_GroupWriteFrame(Group, AddressInstructionSet | Start,
+                           Start, End - Start);
+  }
+}
+
+/**
+ * @brief  Check if one frame can be clocked into all chips
+ * @note   Without PortWrite, the pin functions of the chips are called in
+ *         lockstep, which is not possible if a chip uses Transfer.
+ */
+static uint8_t
+TM1638_GroupHasPins(TM1638_Group_t *Group)
+{
+  if (Group->PortWrite)
+    return 1;
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    if (Group->Chips[i].Transfer)
+      return 0;
+  }
+
+  return 1;
+}
+
+/**
+ * @brief  Check if chips can receive different data in one frame
+ */
+static uint8_t
+TM1638_GroupIsParallel(TM1638_Group_t *Group)
+{
+  uint32_t Used = 0;
+
+  if (!TM1638_GroupHasPins(Group))
+    return 0;
+
+  for (uint8_t i = 0; i < Group->Count; i++)
+  {
+    if (Used & Group->DioMask[i])
+      return 0;
+    Used |= Group->DioMask[i];
+  }
+
+  return 1;
+}
+
+static uint8_t
+TM1638_GroupIsBusy(TM1638_Group_t *Group)
+{
+#if (TM1638_CONFIG_ASYNC)
+  for (uint8_t i = 0; i < Group->Count; i++)
+    if (Group->Chips[i].Async.Busy)
+      return 1;
+#else
+  (void)Group;
+#endif
+  return 0;
+}
+#endif
+
+
+
+/**
+ ==================================================================================
+                           ##### Common Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize TM1638.
+ * @param  Handler: Pointer to handler
+ * @param  Type: Determine the type of display
+ *         - TM1638DisplayTypeComCathode: Common-Cathode
+ *         - TM1638DisplayTypeComAnode:   Common-Anode
+ * @note   If 'TM1638_CONFIG_SUPPORT_COM_ANODE' switch is set to 0, the 'Type'
+ *         argument will be ignored 
+ *         
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful.
+ */
+TM1638_Result_t
+TM1638_Init(TM1638_Handler_t *Handler, uint8_t Type)
+{
+  Handler->DisplayType = TM1638DisplayTypeComCathode;
+
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    Handler->DisplayRegister[i] = 0;
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+    Handler->BackRegister[0][i] = 0;
+    Handler->BackRegister[1][i] = 0;
+#endif
+  }
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  Handler->BackPage = 0;
+  Handler->SwapPending = 0;
+#endif
+#if (TM1638_CONFIG_DIMMING)
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    Handler->DimLevel[i] = TM1638_CONFIG_DIM_STEPS;
+    Handler->DimRegister[i] = 0;
+    for (uint8_t s = 0; s < TM1638_CONFIG_DIM_STEPS; s++)
+      Handler->DimMask[s][i] = 0xFF;
+  }
+  Handler->DimStep = 0;
+#endif
+  // Content of the chip is unknown, the first flush clears all registers
+  Handler->DirtyMask = 0xFFFF;
+  Handler->AutoFlush = 1;
+  Handler->SavedBytes = 0;
+
+#if TM1638_CONFIG_SUPPORT_COM_ANODE
+  if (Type == TM1638DisplayTypeComCathode)
+    Handler->DisplayType = TM1638DisplayTypeComCathode;
+  else
+    Handler->DisplayType = TM1638DisplayTypeComAnode;
+#endif
+
+#if (TM1638_CONFIG_ASYNC)
+  // A job of a previous initialization is dropped
+  Handler->Async.Length = 0;
+  Handler->Async.Busy = 0;
+#endif
+
+  if (TM1638_SetTiming(Handler, &TM1638_DefaultTiming) != TM1638_OK)
+    return TM1638_FAIL;
+  Handler->DioDirection = DioDirectionUnknown;
+  Handler->DisplayControl = 0;
+  Handler->Font = TM1638_DefaultFont;
+
+  Handler->PlatformInit(Handler->Context);
+  return TM1638_OK;
+}
+
+/**
+ * @brief  De-Initialize TM1638.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful.
+ *         - TM1638_BUSY: An asynchronous job is running
+ */
+TM1638_Result_t
+TM1638_DeInit(TM1638_Handler_t *Handler)
+{
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  Handler->PlatformDeInit(Handler->Context);
+  return TM1638_OK;
+}
+
+/**
+ * @brief  Set bus timing profile
+ * @param  Handler: Pointer to handler
+ * @param  Timing: Pointer to timing profile (nanoseconds)
+ * @note   Values are converted once to CPU cycles if DelayCycles is set,
+ *         otherwise to microseconds (rounded up). A zero value removes the
+ *         delay call, which is useful when the GPIO calls themselves are
+ *         slower than the TM1638 minimum timing.
+ * @note   WriteByte, ReadByte and Transfer callbacks get the converted
+ *         profile and apply it in the same units.
+ * @note   TM1638_Init() sets the default profile (1us clock half-periods).
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful.
+ *         - TM1638_BUSY: An asynchronous job is running (timing is kept)
+ */
+TM1638_Result_t
+TM1638_SetTiming(TM1638_Handler_t *Handler, const TM1638_Timing_t *Timing)
+{
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  Handler->Delay.ClkLow = TM1638_NsToDelay(Handler, Timing->ClkLow);
+  Handler->Delay.ClkHigh = TM1638_NsToDelay(Handler, Timing->ClkHigh);
+  Handler->Delay.ReadWait = TM1638_NsToDelay(Handler, Timing->ReadWait);
+  Handler->Delay.ByteGap = TM1638_NsToDelay(Handler, Timing->ByteGap);
+  return TM1638_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                        ##### Public Display Functions #####                       
+ ==================================================================================
+ */
+
+/**
+ * @brief  Config display parameters
+ * @param  Handler: Pointer to handler
+ * @param  Brightness: Set brightness level
+ *         - 0: Display pulse width is set as 1/16
+ *         - 1: Display pulse width is set as 2/16
+ *         - 2: Display pulse width is set as 4/16
+ *         - 3: Display pulse width is set as 10/16
+ *         - 4: Display pulse width is set as 11/16
+ *         - 5: Display pulse width is set as 12/16
+ *         - 6: Display pulse width is set as 13/16
+ *         - 7: Display pulse width is set as 14/16
+ * 
+ * @param  DisplayState: Set display ON or OFF
+ *         - TM1638DisplayStateOFF: Set display state OFF
+ *         - TM1638DisplayStateON: Set display state ON
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
+ */
+TM1638_Result_t
+TM1638_ConfigDisplay(TM1638_Handler_t *Handler,
+                     uint8_t Brightness, uint8_t DisplayState)
+{
+  uint8_t Data = TM1638_DisplayControlCommand(Brightness, DisplayState);
+
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  TM1638_Transfer(Handler, Data, NULL, 0, NULL, 0);
+  Handler->DisplayControl = Data;
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Send changed display registers to TM1638
+ * @note   Only registers changed since the last flush are sent, one frame per
+ *         contiguous run. Nothing is sent if no register has changed.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
+ */
+TM1638_Result_t
+TM1638_Flush(TM1638_Handler_t *Handler)
+{
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  TM1638_WriteRegisterRuns(Handler, 0, TM1638_Output(Handler),
+                           TM1638_TakeDirty(Handler));
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Enable or disable automatic flush
+ * @note   If auto flush is enabled (default), digit functions flush the
+ *         changed registers before returning. Otherwise they only update the
+ *         register image and TM1638_Flush() must be called.
+ * @note   It has no effect if 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled.
+ * @param  Handler: Pointer to handler
+ * @param  Enable: 0 to disable, otherwise enable
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_SetAutoFlush(TM1638_Handler_t *Handler, uint8_t Enable)
+{
+  Handler->AutoFlush = Enable ? 1 : 0;
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Get number of register bytes that were not sent because they had
+ *         not changed
+ * @param  Handler: Pointer to handler
+ * @param  SavedBytes: Pointer to save the result
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_GetSavedBytes(TM1638_Handler_t *Handler, uint32_t *SavedBytes)
+{
+  *SavedBytes = Handler->SavedBytes;
+  return TM1638_OK;
+}
+
+
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+/**
+ * @brief  Publish the back buffer
+ * @note   The rendered back buffer becomes the front buffer and the next
+ *         TM1638_Flush() sends the registers that differ from what was shown
+ *         before. Rendering continues on a copy of the published frame.
+ * @note   It may be called from a different context than TM1638_Flush().
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Previous frame has not been flushed yet
+ */
+TM1638_Result_t
+TM1638_SwapBuffers(TM1638_Handler_t *Handler)
+{
+  uint8_t Page = Handler->BackPage;
+
+  if (Handler->SwapPending)
+    return TM1638_FAIL;
+
+  for (uint8_t i = 0; i < 16; i++)
+    Handler->BackRegister[Page ^ 1][i] = Handler->BackRegister[Page][i];
+
+  Handler->BackPage = Page ^ 1;
+  Handler->SwapPending = 1;
+  return TM1638_OK;
+}
+#endif
+
+
+/**
+ * @brief  Set data to single digit in 7-segment format
+ * @param  Handler: Pointer to handler
+ * @param  DigitData: Digit data
+ * @param  DigitPos: Digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
+ */
+TM1638_Result_t
+TM1638_SetSingleDigit(TM1638_Handler_t *Handler,
+                      uint8_t DigitData, uint8_t DigitPos)
+{ 
+  return TM1638_SetMultipleDigit(Handler, &DigitData, DigitPos, 1);
+}
+
+
+/**
+ * @brief  Set data to multiple digits in 7-segment format
+ * @param  Handler: Pointer to handler
+ * @param  DigitData: Array to Digits data
+ * @param  StartAddr: First digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @param  Count: Number of segments to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
+ */
+TM1638_Result_t
+TM1638_SetMultipleDigit(TM1638_Handler_t *Handler, const uint8_t *DigitData,
+                        uint8_t StartAddr, uint8_t Count)
+{
+  if (TM1638_SetDigits(Handler, DigitData, StartAddr, Count,
+                       EncodeRaw) != TM1638_OK)
+    return TM1638_FAIL;
+
+  TM1638_AutoFlush(Handler);
+
+  return TM1638_OK;
+}
+
+/**
+ * @brief  Set data to multiple digits in 7-segment format
+ * @param  Handler: Pointer to handler
+ * @param  DigitData: Digit data (0, 1, ... , 15, a, A, b, B, ... , f, F) 
+ * @param  DigitPos: Digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
+ */
+TM1638_Result_t
+TM1638_SetSingleDigit_HEX(TM1638_Handler_t *Handler,
+                          uint8_t DigitData, uint8_t DigitPos)
+{
+  return TM1638_SetSingleDigit(Handler,
+                               TM1638_Encode(Handler, EncodeFont, DigitData),
+                               DigitPos);
+}
+
+
+/**
+ * @brief  Set data to multiple digits in hexadecimal format
+ * @param  Handler: Pointer to handler
+ * @param  DigitData: Array to Digits data. 
+ *                    (0, 1, ... , 15, a, A, b, B, ... , f, F)
+ * 
+ * @param  StartAddr: First digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @param  Count: Number of segments to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
+ */
+TM1638_Result_t
+TM1638_SetMultipleDigit_HEX(TM1638_Handler_t *Handler, const uint8_t *DigitData,
+                            uint8_t StartAddr, uint8_t Count)
+{
+  if (TM1638_SetDigits(Handler, DigitData, StartAddr, Count,
+                       EncodeFont) != TM1638_OK)
+    return TM1638_FAIL;
+
+  TM1638_AutoFlush(Handler);
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Set data to multiple digits in char format
+ * @param  Handler: Pointer to handler
+ * @param  DigitData: Array to Digits data. 
+ *                    ASCII characters are converted by the font. With the
+ *                    default font, letters that can not be shown are blank
+ *                    and ~ shows Overscore. Bit 7 sets the decimal point.
+ * 
+ * @param  StartAddr: First digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @param  Count: Number of segments to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
+ */
+TM1638_Result_t
+TM1638_SetMultipleDigit_CHAR(TM1638_Handler_t *Handler, const uint8_t *DigitData,
+                            uint8_t StartAddr, uint8_t Count)
+{
+  if (TM1638_SetDigits(Handler, DigitData, StartAddr, Count,
+                       EncodeFont) != TM1638_OK)
+    return TM1638_FAIL;
+
+  TM1638_AutoFlush(Handler);
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Set font used by HEX and CHAR digit functions
+ * @note   Font is a table of 128 seven-segment codes indexed by ASCII code.
+ *         Entries 0 to 15 are used for digit values 0 to 15. Bit 7 of digit
+ *         data is the decimal point and is added to the font entry.
+ * @note   The font is not copied and must remain valid. On AVR it must be
+ *         placed in program memory (PROGMEM).
+ * @param  Handler: Pointer to handler
+ * @param  Font: Pointer to font (NULL: default font)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_SetFont(TM1638_Handler_t *Handler, const uint8_t *Font)
+{
+  Handler->Font = Font ? Font : TM1638_DefaultFont;
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Set a signed decimal number to multiple digits
+ * @note   8, 16 and 32-bit values are converted without division. A
+ *         negative number gets a '-' before its first digit.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumber(TM1638_Handler_t *Handler, int32_t Number,
+                 uint8_t StartAddr, uint8_t Count, uint8_t Flags)
+{
+  return TM1638_SetNumberFixed(Handler, Number, 0, StartAddr, Count, Flags);
+}
+
+
+/**
+ * @brief  Set an unsigned decimal number to multiple digits
+ * @note   8, 16 and 32-bit values are converted without division.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumberUnsigned(TM1638_Handler_t *Handler, uint32_t Number,
+                         uint8_t StartAddr, uint8_t Count, uint8_t Flags)
+{
+  uint8_t Digits[10];
+  uint8_t Length = TM1638_ToDecimal(Number, Digits);
+
+  return TM1638_SetNumberDigits(Handler, Digits, Length, 0, 0,
+                                StartAddr, Count, Flags);
+}
+
+
+/**
+ * @brief  Set a signed fixed-point number to multiple digits
+ * @note   Number is the value scaled by 10^DecimalPos, e.g. 1234 with
+ *         DecimalPos 2 shows 12.34 and 5 with DecimalPos 2 shows 0.05.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Scaled number to show
+ * @param  DecimalPos: Number of digits after the decimal point
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumberFixed(TM1638_Handler_t *Handler, int32_t Number,
+                      uint8_t DecimalPos, uint8_t StartAddr, uint8_t Count,
+                      uint8_t Flags)
+{
+  uint8_t Digits[10];
+  uint8_t Negative = (Number < 0) ? 1 : 0;
+  uint8_t Length;
+
+  // Magnitude is computed unsigned so INT32_MIN does not overflow
+  Length = TM1638_ToDecimal(Negative ? 0u - (uint32_t)Number : (uint32_t)Number,
+                            Digits);
+
+  return TM1638_SetNumberDigits(Handler, Digits, Length, Negative, DecimalPos,
+                                StartAddr, Count, Flags);
+}
+
+
+/**
+ * @brief  Set an unsigned number to multiple digits in hexadecimal format
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumber_HEX(TM1638_Handler_t *Handler, uint32_t Number,
+                     uint8_t StartAddr, uint8_t Count, uint8_t Flags)
+{
+  uint8_t Digits[8];
+  uint8_t Length = TM1638_ToHex(Number, Digits);
+
+  return TM1638_SetNumberDigits(Handler, Digits, Length, 0, 0,
+                                StartAddr, Count, Flags);
+}
+
+
+/**
+ * @brief  Set state of all discrete LEDs
+ * @note   LED n is bit 0 of register 2n+1, as on LED&KEY boards. Other bits
+ *         of LED registers and digits are not changed, so with auto flush
+ *         disabled LEDs and digits are sent in one burst by TM1638_Flush().
+ * @note   Only Common-Cathode display type is supported.
+ * @param  Handler: Pointer to handler
+ * @param  Mask: Bit n set to turn LED n on
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Display type is Common-Anode
+ */
+TM1638_Result_t
+TM1638_SetLeds(TM1638_Handler_t *Handler, uint8_t Mask)
+{
+  const uint8_t *Image = TM1638_Image(Handler);
+  uint8_t Addr;
+
+  if (Handler->DisplayType != TM1638DisplayTypeComCathode)
+    return TM1638_FAIL;
+
+  for (Addr = 1; Addr < 16; Addr += 2, Mask >>= 1)
+    TM1638_SetRegister(Handler, Addr, (Image[Addr] & 0xFE) | (Mask & 0x01));
+
+  TM1638_AutoFlush(Handler);
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Set state of one discrete LED
+ * @note   See TM1638_SetLeds().
+ * @param  Handler: Pointer to handler
+ * @param  Index: LED number (0 to 7)
+ * @param  State: 0 to turn off, otherwise turn on
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Index is out of range or display type is
+ *                        Common-Anode
+ */
+TM1638_Result_t
+TM1638_SetLed(TM1638_Handler_t *Handler, uint8_t Index, uint8_t State)
+{
+  const uint8_t *Image = TM1638_Image(Handler);
+  uint8_t Addr = (Index << 1) + 1;
+
+  if (Handler->DisplayType != TM1638DisplayTypeComCathode || Index > 7)
+    return TM1638_FAIL;
+
+  TM1638_SetRegister(Handler, Addr,
+                     (Image[Addr] & 0xFE) | (State ? 0x01 : 0x00));
+  TM1638_AutoFlush(Handler);
+
+  return TM1638_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                     ##### Public Transaction Functions #####                      
+ ==================================================================================
+ */
+
+/**
+ * @brief  Begin a display transaction
+ * @note   A transaction collects raw display register writes and a display
+ *         control change. TM1638_TransactionCommit() merges the registers
+ *         into the register image and sends the data command once, one
+ *         address frame per contiguous run of changed registers and a display
+ *         control frame only if the control byte changed.
+ * @param  Handler: Pointer to handler
+ * @param  Transaction: Pointer to transaction
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_TransactionBegin(TM1638_Handler_t *Handler,
+                        TM1638_Transaction_t *Transaction)
+{
+  Transaction->Handler = Handler;
+  Transaction->Pending = 0;
+  Transaction->DisplayControl = 0;
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Add raw display register data to a transaction
+ * @param  Transaction: Pointer to transaction
+ * @param  Data: Array of register data
+ * @param  StartAddr: First register address (0 to 15)
+ * @param  Count: Number of registers to write
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Address range is out of 0 to 15
+ */
+TM1638_Result_t
+TM1638_TransactionWrite(TM1638_Transaction_t *Transaction, const uint8_t *Data,
+                        uint8_t StartAddr, uint8_t Count)
+{
+  if (StartAddr > 15 || Count > 16 - StartAddr)
+    return TM1638_FAIL;
+
+  for (uint8_t i = 0; i < Count; i++)
+  {
+    Transaction->Register[StartAddr + i] = Data[i];
+    Transaction->Pending |= (1U << (StartAddr + i));
+  }
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Add display parameters to a transaction
+ * @param  Transaction: Pointer to transaction
+ * @param  Brightness: Set brightness level (0 to 7, see TM1638_ConfigDisplay)
+ * @param  DisplayState: Set display ON or OFF
+ *         - TM1638DisplayStateOFF: Set display state OFF
+ *         - TM1638DisplayStateON: Set display state ON
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_TransactionConfigDisplay(TM1638_Transaction_t *Transaction,
+                                uint8_t Brightness, uint8_t DisplayState)
+{
+  Transaction->DisplayControl =
+      TM1638_DisplayControlCommand(Brightness, DisplayState);
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Send all collected changes of a transaction
+ * @note   If 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled, the registers are
+ *         written into the shown image and into both buffers. The rest of
+ *         the back buffer stays unpublished and swapping is left to the
+ *         caller. A swap requested before is sent by this commit.
+ * @note   If TM1638_BUSY is returned, nothing is sent and the transaction is
+ *         kept, so the commit can be retried.
+ * @param  Transaction: Pointer to transaction
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
+ */
+TM1638_Result_t
+TM1638_TransactionCommit(TM1638_Transaction_t *Transaction)
+{
+  TM1638_Handler_t *Handler = Transaction->Handler;
+  TM1638_Result_t Result;
+
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  for (uint8_t i = 0; i < 16; i++)
+  {
+    if (Transaction->Pending & (1U << i))
+      TM1638_SetShownRegister(Handler, i, Transaction->Register[i]);
+  }
+
+  Result = TM1638_Flush(Handler);
+  if (Result != TM1638_OK)
+    return Result;
+
+  if (Transaction->DisplayControl &&
+      Transaction->DisplayControl != Handler->DisplayControl)
+  {
+    TM1638_Transfer(Handler, Transaction->DisplayControl, NULL, 0, NULL, 0);
+    Handler->DisplayControl = Transaction->DisplayControl;
+  }
+
+  Transaction->Pending = 0;
+  Transaction->DisplayControl = 0;
+  return TM1638_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                   ##### Public Virtual Display Functions #####                    
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a virtual display
+ * @param  Virtual: Pointer to virtual display
+ * @param  Chips: Array of initialized handlers, first one shows digit 0
+ * @param  Count: Number of handlers
+ * @param  DigitsPerChip: Number of digits of each chip
+ * @param  PositionStep: Distance of digit positions of a chip (1 or 2)
+ *         - 1: Digits are on positions 0, 1, 2, ...
+ *         - 2: Digits are on positions 0, 2, 4, ... (e.g. LEDs on odd ones)
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count, DigitsPerChip or PositionStep is 0
+ */
+TM1638_Result_t
+TM1638_VirtualInit(TM1638_Virtual_t *Virtual, TM1638_Handler_t *Chips,
+                   uint8_t Count, uint8_t DigitsPerChip, uint8_t PositionStep)
+{
+  if (Count == 0 || DigitsPerChip == 0 || PositionStep == 0)
+    return TM1638_FAIL;
+
+  Virtual->Chips = Chips;
+  Virtual->Count = Count;
+  Virtual->DigitsPerChip = DigitsPerChip;
+  Virtual->PositionStep = PositionStep;
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in 7-segment format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                              uint8_t StartDigit, uint8_t Count)
+{
+  return TM1638_VirtualSetDigits(Virtual, DigitData, StartDigit, Count,
+                                 EncodeRaw);
+}
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in hexadecimal format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ *                    (0, 1, ... , 15, a, A, b, B, ... , f, F)
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit_HEX(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                                  uint8_t StartDigit, uint8_t Count)
+{
+  return TM1638_VirtualSetDigits(Virtual, DigitData, StartDigit, Count,
+                                 EncodeFont);
+}
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in char format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ *                    (see TM1638_SetMultipleDigit_CHAR)
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit_CHAR(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                                   uint8_t StartDigit, uint8_t Count)
+{
+  return TM1638_VirtualSetDigits(Virtual, DigitData, StartDigit, Count,
+                                 EncodeFont);
+}
+
+
+/**
+ * @brief  Send changed display registers of all chips of virtual display
+ * @param  Virtual: Pointer to virtual display
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_VirtualFlush(TM1638_Virtual_t *Virtual)
+{
+  TM1638_Result_t Result = TM1638_OK;
+
+  // Other chips are still sent, the busy ones keep their changes
+  for (uint8_t i = 0; i < Virtual->Count; i++)
+  {
+    if (TM1638_Flush(&Virtual->Chips[i]) != TM1638_OK)
+      Result = TM1638_BUSY;
+  }
+
+  return Result;
+}
+
+
+
+/**
+ ==================================================================================
+                        ##### Public Marquee Functions #####                       
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize scrolling text and show its first window
+ * @note   Text is converted to 7-segment format once and saved in Buffer.
+ *         Text and Buffer can be the same array. Buffer must remain valid
+ *         while the marquee is used.
+ * @note   The marquee starts with Speed 1, no pause, forward and without wrap.
+ *         Text that is not longer than the window is shown without scrolling.
+ * @param  Marquee: Pointer to marquee
+ * @param  Handler: Pointer to handler
+ * @param  Buffer: Array of Length bytes to save encoded text
+ * @param  Text: Text in char format (see TM1638_SetMultipleDigit_CHAR)
+ * @param  Length: Length of text
+ * @param  StartAddr: First digit position of the window
+ * @param  Count: Number of digits of the window
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Length or Count is 0 or window is out of range
+ */
+TM1638_Result_t
+TM1638_MarqueeInit(TM1638_Marquee_t *Marquee, TM1638_Handler_t *Handler,
+                   uint8_t *Buffer, const uint8_t *Text, uint8_t Length,
+                   uint8_t StartAddr, uint8_t Count)
+{
+  if (Length == 0 || Count == 0 || Count > 16)
+    return TM1638_FAIL;
+
+  for (uint8_t i = 0; i < Length; i++)
+    Buffer[i] = TM1638_Encode(Handler, EncodeFont, Text[i]);
+
+  Marquee->Handler = Handler;
+  Marquee->Buffer = Buffer;
+  Marquee->Length = Length;
+  Marquee->StartAddr = StartAddr;
+  Marquee->Count = Count;
+
+  return TM1638_MarqueeConfig(Marquee, 1, 0, 0);
+}
+
+
+/**
+ * @brief  Configure scrolling and restart from the first window
+ * @param  Marquee: Pointer to marquee
+ * @param  Speed: Number of ticks per step (0 is taken as 1)
+ * @param  Pause: Extra ticks to stay at the start and end of text
+ * @param  Flags: Combination of
+ *         - TM1638MarqueeReverse: Text moves right instead of left
+ *         - TM1638MarqueeWrap: Text scrolls as a ring, after its last
+ *                              character the first one follows. Otherwise
+ *                              it stops at the end and restarts.
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Window could not be drawn
+ *         - TM1638_BUSY: An asynchronous job is running (window is drawn
+ *                        and sent by the next flush)
+ */
+TM1638_Result_t
+TM1638_MarqueeConfig(TM1638_Marquee_t *Marquee,
+                     uint8_t Speed, uint8_t Pause, uint8_t Flags)
+{
+  TM1638_Result_t Result;
+
+  Marquee->Speed = Speed ? Speed : 1;
+  Marquee->Pause = Pause;
+  Marquee->Flags = Flags;
+
+  Marquee->Position = 0;
+  if (Marquee->Length > Marquee->Count &&
+      (Flags & (TM1638MarqueeReverse | TM1638MarqueeWrap)) ==
+      TM1638MarqueeReverse)
+    Marquee->Position = TM1638_MarqueeLast(Marquee);
+  Marquee->Timer = (uint16_t)Marquee->Speed - 1 + Marquee->Pause;
+
+  Result = TM1638_MarqueeDraw(Marquee);
+  if (Result != TM1638_OK)
+    return Result;
+
+  return TM1638_AutoFlush(Marquee->Handler);
+}
+
+
+/**
+ * @brief  Advance scrolling text
+ * @note   It should be called periodically. On each step only the window is
+ *         written to the register image, without encoding the text again.
+ * @note   If the step can not be drawn or flushed, the position is kept and
+ *         the step is retried on the next call.
+ * @param  Marquee: Pointer to marquee
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Window could not be drawn
+ *         - TM1638_BUSY: An asynchronous job is running
+ */
+TM1638_Result_t
+TM1638_MarqueeTick(TM1638_Marquee_t *Marquee)
+{
+  uint8_t Position = Marquee->Position;
+  TM1638_Result_t Result;
+  uint8_t Last;
+
+  if (Marquee->Length <= Marquee->Count)
+    return TM1638_OK;
+
+  if (Marquee->Timer)
+  {
+    Marquee->Timer--;
+    return TM1638_OK;
+  }
+
+  Last = TM1638_MarqueeLast(Marquee);
+  if (!(Marquee->Flags & TM1638MarqueeReverse))
+    Marquee->Position = (Marquee->Position < Last) ? Marquee->Position + 1 : 0;
+  else
+    Marquee->Position = (Marquee->Position > 0) ? Marquee->Position - 1 : Last;
+
+  Marquee->Timer = Marquee->Speed - 1;
+  if (TM1638_MarqueeAtEnd(Marquee))
+    Marquee->Timer += Marquee->Pause;
+
+  Result = TM1638_MarqueeDraw(Marquee);
+  if (Result == TM1638_OK)
+    Result = TM1638_AutoFlush(Marquee->Handler);
+
+  if (Result != TM1638_OK)
+  {
+    // Same step again on the next tick
+    Marquee->Position = Position;
+    Marquee->Timer = 0;
+  }
+
+  return Result;
+}
+
+
+
+/**
+ ==================================================================================
+                       ##### Public Animation Functions #####                      
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start an animation and show its first frame
+ * @note   Frames are not copied and must remain valid. On AVR they must be
+ *         placed in program memory (PROGMEM).
+ * @note   Registers not selected by Mask are left to other digit functions,
+ *         e.g. an animated digit next to a number.
+ * @param  Animation: Pointer to animation
+ * @param  Handler: Pointer to handler
+ * @param  Frames: Array of frames
+ * @param  Count: Number of frames
+ * @param  Mask: Bit n set to let the animation write register n
+ * @param  Loop: 0 to stop on the last frame, otherwise start over
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count is 0
+ */
+TM1638_Result_t
+TM1638_AnimationStart(TM1638_Animation_t *Animation, TM1638_Handler_t *Handler,
+                      const TM1638_Frame_t *Frames, uint8_t Count,
+                      uint16_t Mask, uint8_t Loop)
+{
+  if (Count == 0)
+    return TM1638_FAIL;
+
+  Animation->Handler = Handler;
+  Animation->Frames = Frames;
+  Animation->Count = Count;
+  Animation->Mask = Mask;
+  Animation->Loop = Loop;
+  Animation->Index = 0;
+  Animation->Running = 1;
+
+  TM1638_AnimationDraw(Animation);
+
+  return TM1638_OK;
+}
+
+
+
+/**
+ ==================================================================================
+                          ##### Public Fade Functions #####                        
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start a brightness fade from the current level
+ * @note   Current level is taken from the last display control command.
+ * @note   Curve is not copied and must remain valid. On AVR it must be placed
+ *         in program memory (PROGMEM).
+ * @param  Fade: Pointer to fade
+ * @param  Handler: Pointer to handler
+ * @param  Level: Target level
+ *         - 0: Display OFF
+ *         - 1 to 8: Display ON with brightness 0 to 7
+ * 
+ * @param  Duration: Number of ticks to reach the target level
+ * @param  Curve: Easing table, entries from 0 (start) to 255 (target) over
+ *                the fade time. NULL for linear fade.
+ * @param  CurveLength: Number of entries of Curve (at least 2)
+ * @param  Mode: Behavior at the end of fade
+ *         - TM1638FadeOnce: Stay at the target level
+ *         - TM1638FadeRepeat: Start over from the start level
+ *         - TM1638FadePulse: Fade back and forth between the two levels
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Level or CurveLength is out of range
+ */
+TM1638_Result_t
+TM1638_FadeStart(TM1638_Fade_t *Fade, TM1638_Handler_t *Handler,
+                 uint8_t Level, uint16_t Duration,
+                 const uint8_t *Curve, uint8_t CurveLength, uint8_t Mode)
+{
+  if (Level > 8 || (Curve && CurveLength < 2))
+    return TM1638_FAIL;
+
+  Fade->Handler = Handler;
+  Fade->Curve = Curve;
+  Fade->CurveLength = CurveLength;
+  Fade->From = TM1638_FadeLevel(Handler->DisplayControl);
+  Fade->To = Level;
+  Fade->Mode = Mode;
+
+  // The only division, ticks only add Increment to Phase
+  Fade->Duration = Duration ? Duration : 1;
+  Fade->Increment = 0xFFFF / Fade->Duration;
+  Fade->Phase = 0;
+  Fade->Remaining = Fade->Duration;
+  Fade->Running = 1;
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Stop a fade, the current level is kept
+ * @param  Fade: Pointer to fade
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_FadeStop(TM1638_Fade_t *Fade)
+{
+  Fade->Running = 0;
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Advance a fade
+ * @note   It should be called periodically. A display control command is
+ *         sent only if the level changes.
+ * @param  Fade: Pointer to fade
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (try again later)
+ */
+TM1638_Result_t
+TM1638_FadeTick(TM1638_Fade_t *Fade)
+{
+  uint8_t Level, Temp;
+
+  if (!Fade->Running)
+    return TM1638_OK;
+
+#if (TM1638_CONFIG_ASYNC)
+  if (Fade->Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  if (--Fade->Remaining)
+  {
+    Fade->Phase += Fade->Increment;
+    Level = TM1638_FadeCompute(Fade);
+  }
+  else
+  {
+    Level = Fade->To;
+
+    if (Fade->Mode == TM1638FadeOnce)
+    {
+      Fade->Running = 0;
+    }
+    else
+    {
+      if (Fade->Mode == TM1638FadePulse)
+      {
+        Temp = Fade->From;
+        Fade->From = Fade->To;
+        Fade->To = Temp;
+      }
+      Fade->Phase = 0;
+      Fade->Remaining = Fade->Duration;
+    }
+  }
+
+  TM1638_FadeApply(Fade->Handler, Level);
+
+  return TM1638_OK;
+}
+
+
+
+#if (TM1638_CONFIG_DIMMING)
+/**
+ ==================================================================================
+                        ##### Public Dimming Functions #####                       
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set brightness of one digit relative to the display brightness
+ * @note   The digit is shown in Level of every TM1638_CONFIG_DIM_STEPS calls
+ *         of TM1638_DimTick(), spread evenly over the cycle. All digits start
+ *         at full level.
+ * @note   On Common-Cathode displays each position is one register, so LEDs
+ *         (usually on odd positions) can be dimmed too.
+ * @param  Handler: Pointer to handler
+ * @param  DigitPos: Digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @param  Level: 0 (off) to TM1638_CONFIG_DIM_STEPS (full)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: DigitPos or Level is out of range
+ */
+TM1638_Result_t
+TM1638_SetDigitLevel(TM1638_Handler_t *Handler, uint8_t DigitPos, uint8_t Level)
+{
+  uint8_t Acc = 0;
+  uint8_t On;
+
+  if (DigitPos > 15 || Level > TM1638_CONFIG_DIM_STEPS)
+    return TM1638_FAIL;
+  if (Handler->DisplayType != TM1638DisplayTypeComCathode && DigitPos > 9)
+    return TM1638_FAIL;
+
+  Handler->DimLevel[DigitPos] = Level;
+
+  // Spread Level on-steps evenly over the cycle
+  for (uint8_t s = 0; s < TM1638_CONFIG_DIM_STEPS; s++)
+  {
+    Acc += Level;
+    On = (Acc >= TM1638_CONFIG_DIM_STEPS);
+    if (On)
+      Acc -= TM1638_CONFIG_DIM_STEPS;
+
+    if (Handler->DisplayType == TM1638DisplayTypeComCathode)
+    {
+      Handler->DimMask[s][DigitPos] = On ? 0xFF : 0x00;
+    }
+    else
+    {
+      // Segment b of digit d is bit (d % 8) of register 2b + d / 8
+      uint8_t Bit = 1 << (DigitPos & 0x07);
+
+      for (uint8_t Addr = DigitPos >> 3; Addr < 16; Addr += 2)
+      {
+        if (On)
+          Handler->DimMask[s][Addr] |= Bit;
+        else
+          Handler->DimMask[s][Addr] &= ~Bit;
+      }
+    }
+  }
+
   return TM1638_OK;
 }
 
+
 /**
- * @brief  Set data to multiple digits in 7-segment format
+ * @brief  Advance the dimming cycle and flush
+ * @note   It should be called periodically, fast enough to avoid flicker
+ *         (e.g. every 2ms with 4 steps). Only registers whose shown value
+ *         changes are sent.
  * @param  Handler: Pointer to handler
- * @param  DigitData: Digit data (0, 1, ... , 15, a, A, b, B, ... , f, F) 
- * @param  DigitPos: Digit position
- *         - 0: Seg1
- *         - 1: Seg2
- *         - .
- *         - .
- *         - .
- * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent and
+ *                        the step is not advanced)
  */
 TM1638_Result_t
-TM1638_SetSingleDigit_HEX(TM1638_Handler_t *Handler,
-                          uint8_t DigitData, uint8_t DigitPos)
+TM1638_DimTick(TM1638_Handler_t *Handler)
+{
+  uint8_t Step = Handler->DimStep;
+  TM1638_Result_t Result;
+
+  if (++Handler->DimStep >= TM1638_CONFIG_DIM_STEPS)
+    Handler->DimStep = 0;
+
+  Result = TM1638_Flush(Handler);
+  // Step was not shown, the next tick tries it again
+  if (Result != TM1638_OK)
+    Handler->DimStep = Step;
+
+  return Result;
+}
+#endif
+
+
+/**
+ * @brief  Stop an animation, the current frame stays on display
+ * @param  Animation: Pointer to animation
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_AnimationStop(TM1638_Animation_t *Animation)
+{
+  Animation->Running = 0;
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Advance an animation
+ * @note   It should be called periodically. When the next frame is due, only
+ *         its registers that differ from the register image are marked to
+ *         be sent.
+ * @param  Animation: Pointer to animation
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_AnimationTick(TM1638_Animation_t *Animation)
 {
-  uint8_t DigitDataHEX = 0;
-  uint8_t DecimalPoint = DigitData & 0x80;
+  if (!Animation->Running)
+    return TM1638_OK;
 
-  DigitData &= 0x7F;
+  if (Animation->Timer)
+  {
+    Animation->Timer--;
+    return TM1638_OK;
+  }
 
-  if (DigitData <= 15)
+  if (Animation->Index + 1 < Animation->Count)
+  {
+    Animation->Index++;
+  }
+  else if (Animation->Loop)
   {
-    DigitDataHEX = HexTo7Seg[DigitData] | DecimalPoint;
+    Animation->Index = 0;
   }
   else
   {
-    switch (DigitData)
-    {
-    case 'A':
-    case 'a':
-      DigitDataHEX = HexTo7Seg[0x0A] | DecimalPoint;
-      break;
-
-    case 'B':
-    case 'b':
-      DigitDataHEX = HexTo7Seg[0x0B] | DecimalPoint;
-      break;
-
-    case 'C':
-    case 'c':
-      DigitDataHEX = HexTo7Seg[0x0C] | DecimalPoint;
-      break;
-
-    case 'D':
-    case 'd':
-      DigitDataHEX = HexTo7Seg[0x0D] | DecimalPoint;
-      break;
-
-    case 'E':
-    case 'e':
-      DigitDataHEX = HexTo7Seg[0x0E] | DecimalPoint;
-      break;
-
-    case 'F':
-    case 'f':
-      DigitDataHEX = HexTo7Seg[0x0F] | DecimalPoint;
-      break;
-
-    default:
-      DigitDataHEX = 0;
-      break;
-    }
+    Animation->Running = 0;
+    return TM1638_OK;
   }
 
-  return TM1638_SetSingleDigit(Handler, DigitDataHEX, DigitPos);
+  TM1638_AnimationDraw(Animation);
+
+  return TM1638_OK;
 }
 
 
+
+#if (TM1638_CONFIG_GROUP)
 /**
- * @brief  Set data to multiple digits in hexadecimal format
- * @param  Handler: Pointer to handler
- * @param  DigitData: Array to Digits data. 
- *                    (0, 1, ... , 15, a, A, b, B, ... , f, F)
+ ==================================================================================
+                         ##### Public Group Functions #####                        
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a group of TM1638s refreshed together
+ * @note   The group starts in pin mode: frames are clocked into all chips
+ *         at once through the pin functions of each chip, which needs a
+ *         separate DIO line per chip. Port layer (or user) can set PortWrite,
+ *         Context, ClkMask, StbMask and DioMask afterwards to write all pins
+ *         of a clock edge at once. Without PortWrite, give chips on a common
+ *         DIO line the same nonzero DioMask to make the group flush them one
+ *         by one (separate STB lines needed).
+ * @param  Group: Pointer to group
+ * @param  Chips: Array of initialized handlers
+ * @param  Count: Number of handlers (1 to 'TM1638_CONFIG_GROUP_MAX_CHIPS')
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count is out of range
+ */
+TM1638_Result_t
+TM1638_GroupInit(TM1638_Group_t *Group, TM1638_Handler_t *Chips, uint8_t Count)
+{
+  if (Count == 0 || Count > TM1638_CONFIG_GROUP_MAX_CHIPS)
+    return TM1638_FAIL;
+
+  Group->Chips = Chips;
+  Group->Count = Count;
+  Group->Context = NULL;
+  Group->PortWrite = NULL;
+  Group->ClkMask = 0;
+  Group->StbMask = 0;
+  for (uint8_t i = 0; i < TM1638_CONFIG_GROUP_MAX_CHIPS; i++)
+    Group->DioMask[i] = 0;
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Send changed display registers of all chips of the group
+ * @note   If each chip has its own DIO line, the union of changed registers
+ *         of all chips is sent in parallel, so all chips are refreshed in the
+ *         time of one. Otherwise (common DIO or a chip with Transfer)
+ *         TM1638_Flush() is called for each chip, which needs a separate STB
+ *         line per chip.
+ * @note   Disable auto flush of the chips to draw into them without sending.
+ * @param  Group: Pointer to group
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_GroupFlush(TM1638_Group_t *Group)
+{
+  uint16_t Mask = 0;
+  uint8_t i;
+
+  if (TM1638_GroupIsBusy(Group))
+    return TM1638_BUSY;
+
+  if (!TM1638_GroupIsParallel(Group))
+  {
+    for (i = 0; i < Group->Count; i++)
+      TM1638_Flush(&Group->Chips[i]);
+    return TM1638_OK;
+  }
+
+  for (i = 0; i < Group->Count; i++)
+    Mask |= TM1638_TakeDirty(&Group->Chips[i]);
+
+  if (Mask)
+    TM1638_GroupWriteRuns(Group, Mask);
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Config display of all chips of the group
+ * @note   STB of all chips is lowered together and the command is sent once.
+ *         If a chip uses Transfer and PortWrite is not set,
+ *         TM1638_ConfigDisplay() is called for each chip instead.
+ * @param  Group: Pointer to group
+ * @param  Brightness: Set brightness level
+ *         - 0: Display pulse width is set as 1/16
+ *         - 1: Display pulse width is set as 2/16
+ *         - 2: Display pulse width is set as 4/16
+ *         - 3: Display pulse width is set as 10/16
+ *         - 4: Display pulse width is set as 11/16
+ *         - 5: Display pulse width is set as 12/16
+ *         - 6: Display pulse width is set as 13/16
+ *         - 7: Display pulse width is set as 14/16
  * 
- * @param  StartAddr: First digit position
- *         - 0: Seg1
- *         - 1: Seg2
- *         - .
- *         - .
- *         - .
+ * @param  DisplayState: Set display ON or OFF
+ *         - TM1638DisplayStateOFF: Set display state OFF
+ *         - TM1638DisplayStateON: Set display state ON
  * 
- * @param  Count: Number of segments to write data
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
  */
 TM1638_Result_t
-TM1638_SetMultipleDigit_HEX(TM1638_Handler_t *Handler, const uint8_t *DigitData,
-                            uint8_t StartAddr, uint8_t Count)
+TM1638_GroupConfigDisplay(TM1638_Group_t *Group,
+                          uint8_t Brightness, uint8_t DisplayState)
 {
-  uint8_t DigitDataHEX[10];
-  uint8_t DecimalPoint = 0;
+  uint8_t Data = TM1638_DisplayControlCommand(Brightness, DisplayState);
+  uint8_t i;
 
-  for (uint8_t i = 0; i < Count; i++)
+  if (TM1638_GroupIsBusy(Group))
+    return TM1638_BUSY;
+
+  if (!TM1638_GroupHasPins(Group))
   {
-    DecimalPoint = DigitData[i] & 0x80;
+    for (i = 0; i < Group->Count; i++)
+      TM1638_ConfigDisplay(&Group->Chips[i], Brightness, DisplayState);
+    return TM1638_OK;
+  }
 
-    if ((DigitData[i] & 0x7F) >= 0 && (DigitData[i] & 0x7F) <= 15)
-    {
-      DigitDataHEX[i] = HexTo7Seg[DigitData[i] & 0x7F] | DecimalPoint;
-    }
-    else
-    {
-      switch (DigitData[i] & 0x7F)
-      {
-      case 'A':
-      case 'a':
-        DigitDataHEX[i] = HexTo7Seg[0x0A] | DecimalPoint;
-        break;
-
-      case 'B':
-      case 'b':
-        DigitDataHEX[i] = HexTo7Seg[0x0B] | DecimalPoint;
-        break;
-
-      case 'C':
-      case 'c':
-        DigitDataHEX[i] = HexTo7Seg[0x0C] | DecimalPoint;
-        break;
-
-      case 'D':
-      case 'd':
-        DigitDataHEX[i] = HexTo7Seg[0x0D] | DecimalPoint;
-        break;
-
-      case 'E':
-      case 'e':
-        DigitDataHEX[i] = HexTo7Seg[0x0E] | DecimalPoint;
-        break;
-
-      case 'F':
-      case 'f':
-        DigitDataHEX[i] = HexTo7Seg[0x0F] | DecimalPoint;
-        break;
-
-      default:
-        DigitDataHEX[i] = 0;
-        break;
-      }
-    }
+  for (i = 0; i < Group->Count; i++)
+  {
+    TM1638_DioOut(&Group->Chips[i]);
+    Group->Chips[i].DisplayControl = Data;
   }
+  TM1638_GroupWriteFrame(Group, Data, 0, 0);
 
-  return TM1638_SetMultipleDigit(Handler,
-                                 (const uint8_t *)DigitDataHEX, StartAddr, Count);
+  return TM1638_OK;
 }
 
 
 /**
- * @brief  Set data to multiple digits in char format
- * @param  Handler: Pointer to handler
- * @param  DigitData: Array to Digits data. 
- *                    Supported chars 0,1,2,3,4,5,6,7,8,9
- *                                    A,b,C,d,E,F,g,G,h,H,i,I,j,l,L,n,N,o,O,P,q,r,S,
- *                                    t,u,U,y,_,-,Overscore (use ~ to set)
- * 
- * @param  StartAddr: First digit position
- *         - 0: Seg1
- *         - 1: Seg2
- *         - .
- *         - .
- *         - .
- * 
- * @param  Count: Number of segments to write data
+ * @brief  Write the same display registers to all chips of the group
+ * @note   Useful for clears and test patterns. STB of all chips is lowered
+ *         together and the registers are sent once. If a chip uses Transfer
+ *         and PortWrite is not set, they are sent to each chip instead.
+ *         Register images of all chips are updated, including both buffers
+ *         if 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled, so the registers stay
+ *         until they are drawn again.
+ * @param  Group: Pointer to group
+ * @param  Data: Register data
+ * @param  StartAddr: First register address (0 to 15)
+ * @param  Count: Number of registers
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Address range is out of 0 to 15
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
  */
 TM1638_Result_t
-TM1638_SetMultipleDigit_CHAR(TM1638_Handler_t *Handler, const uint8_t *DigitData,
-                            uint8_t StartAddr, uint8_t Count)
+TM1638_GroupWriteAll(TM1638_Group_t *Group, const uint8_t *Data,
+                     uint8_t StartAddr, uint8_t Count)
 {
-  uint8_t DigitDataHEX[10];
-  uint8_t DecimalPoint = 0;
+  uint16_t Mask;
+  uint8_t i, j;
 
-  for (uint8_t i = 0; i < Count; i++)
+  if (StartAddr > 15 || Count > 16 - StartAddr)
+    return TM1638_FAIL;
+
+  if (TM1638_GroupIsBusy(Group))
+    return TM1638_BUSY;
+
+  if (Count == 0)
+    return TM1638_OK;
+
+  Mask = (uint16_t)(((1UL << Count) - 1) << StartAddr);
+
+  for (i = 0; i < Group->Count; i++)
   {
-    DecimalPoint = DigitData[i] & 0x80;
+    for (j = 0; j < Count; j++)
+      TM1638_SetSentRegister(&Group->Chips[i], StartAddr + j, Data[j]);
+  }
 
-    // numbers 0 - 9
-    if ((DigitData[i] & 0x7F) >= (uint8_t)'0' && (DigitData[i] & 0x7F) <= (uint8_t)'9')
-    {
-      DigitDataHEX[i] = HexTo7Seg[(DigitData[i]-48) & 0x7F] | DecimalPoint;
-    }
-    else
-    {
-      switch (DigitData[i] & 0x7F)
-      {
-      case 'A':
-      case 'a':
-        DigitDataHEX[i] = HexTo7Seg[0x0A] | DecimalPoint;
-        break;
-
-      case 'B':
-      case 'b':
-        DigitDataHEX[i] = HexTo7Seg[0x0B] | DecimalPoint;
-        break;
-
-      case 'C':
-      case 'c':
-        DigitDataHEX[i] = HexTo7Seg[0x0C] | DecimalPoint;
-        break;
-
-      case 'D':
-      case 'd':
-        DigitDataHEX[i] = HexTo7Seg[0x0D] | DecimalPoint;
-        break;
-
-      case 'E':
-      case 'e':
-        DigitDataHEX[i] = HexTo7Seg[0x0E] | DecimalPoint;
-        break;
-
-      case 'F':
-      case 'f':
-        DigitDataHEX[i] = HexTo7Seg[0x0F] | DecimalPoint;
-        break;
-
-      case 'g':
-        DigitDataHEX[i] = HexTo7Seg[0x10] | DecimalPoint;
-      break;
-      
-      case 'G':
-        DigitDataHEX[i] = HexTo7Seg[0x11] | DecimalPoint;
-      break;
-
-      case 'h':
-        DigitDataHEX[i] = HexTo7Seg[0x12] | DecimalPoint;
-      break;
-      
-      case 'H':
-        DigitDataHEX[i] = HexTo7Seg[0x13] | DecimalPoint;
-      break;
-
-      case 'i':
-        DigitDataHEX[i] = HexTo7Seg[0x14] | DecimalPoint;
-      break;
-      
-      case 'I':
-        DigitDataHEX[i] = HexTo7Seg[0x15] | DecimalPoint;
-      break;
-
-      case 'j':
-      case 'J':
-        DigitDataHEX[i] = HexTo7Seg[0x16] | DecimalPoint;
-      break;
-
-      case 'l':
-        DigitDataHEX[i] = HexTo7Seg[0x17] | DecimalPoint;
-      break;
-
-      case 'L':
-        DigitDataHEX[i] = HexTo7Seg[0x18] | DecimalPoint;
-      break;
-
-      case 'n':
-        DigitDataHEX[i] = HexTo7Seg[0x19] | DecimalPoint;
-      break;
-      
-      case 'N':
-        DigitDataHEX[i] = HexTo7Seg[0x1A] | DecimalPoint;
-      break;
-
-      case 'o':
-        DigitDataHEX[i] = HexTo7Seg[0x1B] | DecimalPoint;
-      break;
-      
-      case 'O':
-        DigitDataHEX[i] = HexTo7Seg[0x1C] | DecimalPoint;
-      break;
-
-      case 'p':
-      case 'P':
-        DigitDataHEX[i] = HexTo7Seg[0x1D] | DecimalPoint;
-      break;
-
-      case 'q':
-      case 'Q':
-        DigitDataHEX[i] = HexTo7Seg[0x1E] | DecimalPoint;
-      break;
-
-      case 'r':
-      case 'R':
-        DigitDataHEX[i] = HexTo7Seg[0x1F] | DecimalPoint;
-      break;
-
-      case 's':
-      case 'S':
-        DigitDataHEX[i] = HexTo7Seg[0x20] | DecimalPoint;
-      break;
-
-      case 't':
-      case 'T':
-        DigitDataHEX[i] = HexTo7Seg[0x21] | DecimalPoint;
-      break;
-
-      case 'u':
-        DigitDataHEX[i] = HexTo7Seg[0x22] | DecimalPoint;
-      break;
-
-      case 'U':
-        DigitDataHEX[i] = HexTo7Seg[0x23] | DecimalPoint;
-      break;
-
-      case 'y':
-      case 'Y':
-        DigitDataHEX[i] = HexTo7Seg[0x24] | DecimalPoint;
-      break;
-
-      case '_':
-        DigitDataHEX[i] = HexTo7Seg[0x25] | DecimalPoint;
-      break;
-
-      case '-':
-        DigitDataHEX[i] = HexTo7Seg[0x26] | DecimalPoint;
-      break;
-
-      case '~':
-        DigitDataHEX[i] = HexTo7Seg[0x27] | DecimalPoint;
-      break;
-
-      default:
-        DigitDataHEX[i] = 0;
-        break;
-      }
-    }
+  if (TM1638_GroupHasPins(Group))
+  {
+    TM1638_GroupWriteRuns(Group, Mask);
+  }
+  else
+  {
+    for (i = 0; i < Group->Count; i++)
+      TM1638_WriteRegisterRuns(&Group->Chips[i], 0,
+                               TM1638_Output(&Group->Chips[i]), Mask);
   }
 
-  return TM1638_SetMultipleDigit(Handler,
-                                 (const uint8_t *)DigitDataHEX, StartAddr, Count);
+  return TM1638_OK;
 }
+#endif
 
 
 
@@ -751,35 +2887,225 @@ TM1638_SetMultipleDigit_CHAR(TM1638_Handler_t *Handler, const uint8_t *DigitData
  * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (keys are not read)
  */
 TM1638_Result_t
 TM1638_ScanKeys(TM1638_Handler_t *Handler, uint32_t *Keys)
 {
   uint8_t KeyRegs[4];
-  uint32_t KeysBuff = 0;
-  uint8_t Kn = 0x01;
+
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
 
   TM1638_ScanKeyRegs(Handler, KeyRegs);
+  *Keys = TM1638_DecodeKeys(KeyRegs);
 
-  for (uint8_t i = 0; i < 3; i++)
-  {
-    for (int8_t i = 3; i >= 0; i--)
-    {
-      KeysBuff <<= 1;
+  return TM1638_OK;
+}
 
-      if (KeyRegs[i] & (Kn << 4))
-        KeysBuff |= 1;
 
-      KeysBuff <<= 1;
+/**
+ * @brief  Read key scan data registers without decoding
+ * @param  Handler: Pointer to handler
+ * @param  KeyRegs: Array of 4 bytes to save BYTE1 to BYTE4 of key scan data
+ *         - bit0=>K3_SEG(2n+1), bit1=>K2_SEG(2n+1), bit2=>K1_SEG(2n+1),
+ *         - bit4=>K3_SEG(2n+2), bit5=>K2_SEG(2n+2), bit6=>K1_SEG(2n+2)
+ *           for KeyRegs[n]
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (keys are not read)
+ */
+TM1638_Result_t
+TM1638_ScanKeysRaw(TM1638_Handler_t *Handler, uint8_t *KeyRegs)
+{
+#if (TM1638_CONFIG_ASYNC)
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+#endif
+
+  TM1638_ScanKeyRegs(Handler, KeyRegs);
 
-      if (KeyRegs[i] & Kn)
-        KeysBuff |= 1;
-    }
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Initialize a key debouncer with all keys released
+ * @param  Debounce: Pointer to debouncer
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_DebounceInit(TM1638_Debounce_t *Debounce)
+{
+  Debounce->State = 0;
+  Debounce->Pressed = 0;
+  Debounce->Released = 0;
+  Debounce->Count0 = 0;
+  Debounce->Count1 = 0;
+
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Debounce a key scan result
+ * @note   A key changes its stable state after it is read in the new state
+ *         in 4 scans in a row. All 24 keys are processed together by a few
+ *         bitwise operations. Pressed and Released of the debouncer are set
+ *         to the keys that changed in this call.
+ * @param  Debounce: Pointer to debouncer
+ * @param  Keys: Key scan result (see TM1638_ScanKeys)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_DebounceUpdate(TM1638_Debounce_t *Debounce, uint32_t Keys)
+{
+  uint32_t Delta, Toggle;
+
+  // Counters of keys that read as their stable state are reset
+  Delta = Keys ^ Debounce->State;
+  Debounce->Count1 = (Debounce->Count1 ^ Debounce->Count0) & Delta;
+  Debounce->Count0 = ~Debounce->Count0 & Delta;
+
+  // Counter wrapped to 0 after 4 scans in the new state
+  Toggle = Delta & ~(Debounce->Count0 | Debounce->Count1);
+  Debounce->State ^= Toggle;
+  Debounce->Pressed = Toggle & Debounce->State;
+  Debounce->Released = Toggle & ~Debounce->State;
+
+  return TM1638_OK;
+}
+
+
+
+#if (TM1638_CONFIG_ASYNC)
+/**
+ ==================================================================================
+                     ##### Public Asynchronous Functions #####                     
+ ==================================================================================
+ */
+
+/**
+ * @brief  Queue a flush of changed display registers
+ * @note   The job is built from the register image when queued and is sent
+ *         by TM1638_Poll() or TM1638_TimerTick(). Blocking bus functions
+ *         return TM1638_BUSY while the job is running.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Job queued
+ *         - TM1638_BUSY: Another job is running
+ */
+TM1638_Result_t
+TM1638_FlushAsync(TM1638_Handler_t *Handler)
+{
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+
+  Handler->Async.Length = 0;
+  TM1638_WriteRegisterRuns(Handler, 1, TM1638_Output(Handler),
+                           TM1638_TakeDirty(Handler));
+  TM1638_AsyncStart(Handler, TM1638AsyncJobFlush);
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Queue a key scan
+ * @note   Use TM1638_GetAsyncKeys() to get the result after completion.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Job queued
+ *         - TM1638_BUSY: Another job is running
+ */
+TM1638_Result_t
+TM1638_ScanKeysAsync(TM1638_Handler_t *Handler)
+{
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+
+  Handler->Async.Length = 0;
+  TM1638_QueueFrame(Handler,
+                    DataInstructionSet | ReadKeyScanData |
+                    AutoAddressAdd | NormalMode,
+                    NULL, 0, 4);
+  TM1638_AsyncStart(Handler, TM1638AsyncJobScan);
+  return TM1638_OK;
+}
+
+
+/**
+ * @brief  Advance the running job
+ * @note   Each call clocks at most 'TM1638_CONFIG_ASYNC_BITS_PER_POLL' bits
+ *         (or one whole frame if Transfer callback is used). AsyncDone
+ *         callback is called when the job completes.
+ * @note   If TimerStart callback is set, it only returns the job state.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: No job is running (completed)
+ *         - TM1638_BUSY: Job is still running
+ */
+TM1638_Result_t
+TM1638_Poll(TM1638_Handler_t *Handler)
+{
+  uint8_t Bits = 0;
+  uint8_t Phase;
+
+  if (Handler->TimerStart)
+    Bits = TM1638_CONFIG_ASYNC_BITS_PER_POLL;
 
-    Kn <<= 1;
+  while (Handler->Async.Busy && Bits < TM1638_CONFIG_ASYNC_BITS_PER_POLL)
+  {
+    Phase = Handler->Async.Phase;
+    TM1638_Delay(Handler, TM1638_AsyncStep(Handler));
+
+    if (Handler->Transfer)
+      Bits = TM1638_CONFIG_ASYNC_BITS_PER_POLL;
+    else if (Phase == AsyncPhaseWriteHigh || Phase == AsyncPhaseReadHigh)
+      Bits++;
   }
 
-  *Keys = KeysBuff;
+  return Handler->Async.Busy ? TM1638_BUSY : TM1638_OK;
+}
+
 
+/**
+ * @brief  Advance the running job by one clock half-period
+ * @note   Call it from the timer interrupt started by TimerStart callback.
+ *         Bus delays are not applied, so the timer period sets the clock
+ *         half-period and must be at least 1us (read wait of TM1638).
+ *         TimerStop and AsyncDone callbacks are called from this function
+ *         when the job completes.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+TM1638_TimerTick(TM1638_Handler_t *Handler)
+{
+  if (Handler->Async.Busy)
+    (void)TM1638_AsyncStep(Handler);
+}
+
+
+/**
+ * @brief  Get result of the last completed asynchronous key scan
+ * @param  Handler: Pointer to handler
+ * @param  Keys: pointer to save key scan result (see TM1638_ScanKeys)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: A job is running
+ */
+TM1638_Result_t
+TM1638_GetAsyncKeys(TM1638_Handler_t *Handler, uint32_t *Keys)
+{
+  if (Handler->Async.Busy)
+    return TM1638_BUSY;
+
+  *Keys = TM1638_DecodeKeys(Handler->Async.KeyRegs);
   return TM1638_OK;
 }
+#endif
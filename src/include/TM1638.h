@@ -50,6 +50,42 @@ extern "C" {
   #define TM1638_CONFIG_SUPPORT_COM_ANODE  1
 #endif
 
+#ifndef TM1638_CONFIG_FRAME_OVERHEAD_BITS
+  #define TM1638_CONFIG_FRAME_OVERHEAD_BITS  16
+#endif
+
+#ifndef TM1638_CONFIG_DOUBLE_BUFFER
+  #define TM1638_CONFIG_DOUBLE_BUFFER  0
+#endif
+
+#ifndef TM1638_CONFIG_STATIC_PINS
+  #define TM1638_CONFIG_STATIC_PINS  0
+#endif
+
+#ifndef TM1638_CONFIG_GROUP
+  #define TM1638_CONFIG_GROUP  0
+#endif
+
+#ifndef TM1638_CONFIG_GROUP_MAX_CHIPS
+  #define TM1638_CONFIG_GROUP_MAX_CHIPS  8
+#endif
+
+#ifndef TM1638_CONFIG_ASYNC
+  #define TM1638_CONFIG_ASYNC  0
+#endif
+
+#ifndef TM1638_CONFIG_ASYNC_BITS_PER_POLL
+  #define TM1638_CONFIG_ASYNC_BITS_PER_POLL  8
+#endif
+
+#ifndef TM1638_CONFIG_DIMMING
+  #define TM1638_CONFIG_DIMMING  0
+#endif
+
+#ifndef TM1638_CONFIG_DIM_STEPS
+  #define TM1638_CONFIG_DIM_STEPS  4
+#endif
+
 
 /* Exported Constants -----------------------------------------------------------*/
 #define TM1638DisplayTypeComCathode 0
@@ -60,8 +96,62 @@ extern "C" {
 
 #define TM1638DecimalPoint    0x80
 
+#define TM1638NumberZeroPad   0x01
+
+#define TM1638MarqueeReverse  0x01
+#define TM1638MarqueeWrap     0x02
+
+#define TM1638FadeOnce        0
+#define TM1638FadeRepeat      1
+#define TM1638FadePulse       2
+
+#define TM1638AsyncJobFlush   1
+#define TM1638AsyncJobScan    2
+
   
 /* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  Bus timing profile
+ * @note   TM1638 minimums: CLK pulse width 400ns, DIO setup and hold 100ns,
+ *         1us wait between the read command and the first read clock.
+ *         For 1MHz bus use ClkLow = ClkHigh = 500.
+ */
+typedef struct TM1638_Timing_s
+{
+  // CLK low time, DIO changes and sets up during it
+  uint16_t ClkLow;
+  // CLK high time, DIO is held and sampled during it
+  uint16_t ClkHigh;
+  // Wait between the read command and the first read clock
+  uint16_t ReadWait;
+  // Gap between two read bytes
+  uint16_t ByteGap;
+} TM1638_Timing_t;
+
+/**
+ * @brief  Asynchronous engine state (used by library)
+ */
+typedef struct TM1638_Async_s
+{
+  // Queued frames: header (write count | read count << 5) followed by bytes
+  uint8_t Job[34];
+  uint8_t Length;
+  uint8_t Index;
+  // Remaining bytes of current frame to write and read
+  uint8_t Write;
+  uint8_t Read;
+  // Byte being shifted, its bit number and current step of the frame
+  uint8_t Data;
+  uint8_t Bit;
+  uint8_t Phase;
+  // Running job (TM1638AsyncJobFlush or TM1638AsyncJobScan)
+  uint8_t Type;
+  // Key registers of the last key scan job
+  uint8_t Received;
+  uint8_t KeyRegs[4];
+  volatile uint8_t Busy;
+} TM1638_Async_t;
+
 /**
  * @brief  Handler data type
  * @note   User must initialize this this functions before using library:
@@ -74,47 +164,290 @@ extern "C" {
  *         - ClkWrite
  *         - StbWrite
  *         - DelayUs
+ *
+ *         Optional functions (set them to NULL if not used):
+ *         - WriteByte
+ *         - ReadByte
+ *         - Transfer
+ *         - DelayCycles (with CpuFreqMHz)
+ *         - AsyncDone, TimerStart, TimerStop (if 'TM1638_CONFIG_ASYNC' is
+ *           enabled)
+ *
+ *         If Transfer is set, DIO, CLK and STB functions are not used by the
+ *         library and can be left NULL.
+ *
+ *         Context is passed to all platform functions, so one set of
+ *         functions can serve several TM1638 chips.
  */
 typedef struct TM1638_Handler_s
 {
+  // Passed as first argument to all platform functions (e.g. pins descriptor)
+  void *Context;
+
   // Initialize the platform-dependent layer
-  void (*PlatformInit)(void);
+  void (*PlatformInit)(void *Context);
   // Uninitialize the platform-dependent layer
-  void (*PlatformDeInit)(void);
+  void (*PlatformDeInit)(void *Context);
 
   // Config the GPIO that connected to DIO PIN of SHT1x as output
-  void (*DioConfigOut)(void);
+  void (*DioConfigOut)(void *Context);
   // Config the GPIO that connected to DIO PIN of SHT1x as input
-  void (*DioConfigIn)(void);
+  void (*DioConfigIn)(void *Context);
   // Set level of the GPIO that connected to DIO PIN of SHT1x
-  void (*DioWrite)(uint8_t);
+  void (*DioWrite)(void *Context, uint8_t Level);
   // Read the GPIO that connected to DIO PIN of SHT1x
-  uint8_t (*DioRead)(void);
+  uint8_t (*DioRead)(void *Context);
 
   // Set level of the GPIO that connected to CLK PIN of SHT1x
-  void (*ClkWrite)(uint8_t);
+  void (*ClkWrite)(void *Context, uint8_t Level);
 
   // Set level of the GPIO that connected to STB PIN of SHT1x
-  void (*StbWrite)(uint8_t);
+  void (*StbWrite)(void *Context, uint8_t Level);
 
   // Delay (us)
-  void (*DelayUs)(uint8_t);
+  void (*DelayUs)(void *Context, uint8_t Delay);
+
+  // Write a byte LSB-first to DIO with its clock pulses (optional)
+  // DIO is already configured as output. Delay is the active profile, each
+  // bit waits Delay->ClkLow and Delay->ClkHigh (zero: no delay).
+  void (*WriteByte)(void *Context, uint8_t Data, const TM1638_Timing_t *Delay);
+  // Read a byte LSB-first from DIO with its clock pulses (optional)
+  // DIO is already configured as input. Timing is the same as WriteByte,
+  // ReadWait and ByteGap are handled by the library.
+  uint8_t (*ReadByte)(void *Context, const TM1638_Timing_t *Delay);
+
+  // Send a complete STB-framed transaction (optional)
+  // Command byte and TxLen bytes of TxData are sent LSB-first, then RxLen
+  // bytes are read into RxData (LSB-first). The port toggles STB around the
+  // whole frame and waits Delay->ReadWait before the read phase. It suits
+  // SPI peripherals in half-duplex mode with STB as chip select.
+  void (*Transfer)(void *Context, uint8_t Command,
+                   const uint8_t *TxData, uint8_t TxLen,
+                   uint8_t *RxData, uint8_t RxLen,
+                   const TM1638_Timing_t *Delay);
+
+  // Delay (CPU cycles), optional. Used instead of DelayUs when set
+  void (*DelayCycles)(void *Context, uint16_t Cycles);
+  // CPU clock (MHz). Used to convert timing profile to cycles
+  uint16_t CpuFreqMHz;
+
+  // Active bus delays in DelayUs or DelayCycles units (set by library)
+  TM1638_Timing_t Delay;
+
+  // Current direction of DIO pin (set by library, output between frames)
+  uint8_t DioDirection;
+
+  // Last display control command sent (set by library, 0: not sent yet)
+  uint8_t DisplayControl;
 
   uint8_t DisplayType;
 
-#if (TM1638_CONFIG_SUPPORT_COM_ANODE)
+  // ASCII to 7-segment table, 128 entries (set by library)
+  const uint8_t *Font;
+
+  // Image of display registers of TM1638 (set by library)
   uint8_t DisplayRegister[16];
+  // Bit n is set if DisplayRegister[n] has not been sent yet
+  uint16_t DirtyMask;
+  // Flush after each digit function call
+  uint8_t AutoFlush;
+  // Number of register bytes not sent because they had not changed
+  uint32_t SavedBytes;
+
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+  // Back buffers, digit functions draw into BackRegister[BackPage]
+  uint8_t BackRegister[2][16];
+  volatile uint8_t BackPage;
+  // Set when a published frame waits for TM1638_Flush()
+  volatile uint8_t SwapPending;
+#endif
+
+#if (TM1638_CONFIG_DIMMING)
+  // Dim level of each digit position (set by library)
+  uint8_t DimLevel[16];
+  // Register bits shown at each step of the dimming cycle (set by library)
+  uint8_t DimMask[TM1638_CONFIG_DIM_STEPS][16];
+  // Registers as sent to TM1638 (set by library)
+  uint8_t DimRegister[16];
+  uint8_t DimStep;
+#endif
+
+#if (TM1638_CONFIG_ASYNC)
+  // Called when an asynchronous job completes (optional)
+  void (*AsyncDone)(struct TM1638_Handler_s *Handler, uint8_t Job);
+  // Start and stop the periodic timer which calls TM1638_TimerTick()
+  // (optional). If set, jobs are clocked by the timer instead of TM1638_Poll()
+  void (*TimerStart)(void *Context);
+  void (*TimerStop)(void *Context);
+  TM1638_Async_t Async;
 #endif
 } TM1638_Handler_t;
 
 
+/**
+ * @brief  Display transaction data type
+ */
+typedef struct TM1638_Transaction_s
+{
+  TM1638_Handler_t *Handler;
+  // Register data to be written
+  uint8_t Register[16];
+  // Bit n is set if Register[n] must be written
+  uint16_t Pending;
+  // Display control command to be sent (0: no change)
+  uint8_t DisplayControl;
+} TM1638_Transaction_t;
+
+
+/**
+ * @brief  Virtual display spanning several TM1638s data type
+ * @note   Logical digit n is shown on chip n / DigitsPerChip at digit
+ *         position (n % DigitsPerChip) * PositionStep.
+ */
+typedef struct TM1638_Virtual_s
+{
+  TM1638_Handler_t *Chips;
+  uint8_t Count;
+  uint8_t DigitsPerChip;
+  uint8_t PositionStep;
+} TM1638_Virtual_t;
+
+
+/**
+ * @brief  Scrolling text data type
+ * @note   Buffer holds the text in 7-segment format, it is encoded once by
+ *         TM1638_MarqueeInit(). Digits StartAddr to StartAddr+Count-1 show
+ *         Buffer[Position] onwards.
+ */
+typedef struct TM1638_Marquee_s
+{
+  TM1638_Handler_t *Handler;
+  uint8_t *Buffer;
+  uint8_t Length;
+  uint8_t StartAddr;
+  uint8_t Count;
+
+  // Ticks per step, ticks to stay at ends and TM1638Marquee* flags
+  uint8_t Speed;
+  uint8_t Pause;
+  uint8_t Flags;
+
+  // Scroll state (set by library)
+  uint8_t Position;
+  uint16_t Timer;
+} TM1638_Marquee_t;
+
+
+/**
+ * @brief  Animation frame data type
+ * @note   Register holds raw display registers, Duration is the number of
+ *         ticks the frame is shown (0 is taken as 1).
+ */
+typedef struct TM1638_Frame_s
+{
+  uint8_t Register[16];
+  uint16_t Duration;
+} TM1638_Frame_t;
+
+
+/**
+ * @brief  Animation player data type
+ */
+typedef struct TM1638_Animation_s
+{
+  TM1638_Handler_t *Handler;
+  const TM1638_Frame_t *Frames;
+  uint8_t Count;
+  // Bit n is set if register n is written by the animation
+  uint16_t Mask;
+  uint8_t Loop;
+
+  // Playback state (set by library)
+  uint8_t Index;
+  uint16_t Timer;
+  uint8_t Running;
+} TM1638_Animation_t;
+
+
+/**
+ * @brief  Brightness fade data type
+ * @note   Levels are 0 (display off) and 1 to 8 (brightness 0 to 7).
+ */
+typedef struct TM1638_Fade_s
+{
+  TM1638_Handler_t *Handler;
+  // Easing table from 0 (start level) to 255 (target level), NULL: linear
+  const uint8_t *Curve;
+  uint8_t CurveLength;
+  uint8_t From;
+  uint8_t To;
+  uint8_t Mode;
+
+  // Fade state (set by library)
+  uint16_t Phase;
+  uint16_t Increment;
+  uint16_t Remaining;
+  uint16_t Duration;
+  uint8_t Running;
+} TM1638_Fade_t;
+
+
+/**
+ * @brief  Key debouncer data type
+ * @note   Bit n of each field belongs to bit n of the key scan result.
+ *         Count0 and Count1 hold a 2-bit counter of each key.
+ */
+typedef struct TM1638_Debounce_s
+{
+  // Debounced state of keys
+  uint32_t State;
+  // Keys pressed and released at the last update
+  uint32_t Pressed;
+  uint32_t Released;
+
+  // Vertical counters (set by library)
+  uint32_t Count0;
+  uint32_t Count1;
+} TM1638_Debounce_t;
+
+
+/**
+ * @brief  Group of TM1638s with common CLK data type
+ * @note   PortWrite sets the bits of SetMask and clears the bits of ClearMask
+ *         in one write, so all pins must be on one port. DIO of chips can be
+ *         common (broadcast only) or separate (broadcast and parallel flush).
+ *         StbMask holds STB of all chips, common or separate.
+ * @note   Without PortWrite, the pin functions of each chip are called in
+ *         lockstep. DioMask then only tells which chips share a DIO line.
+ */
+typedef struct TM1638_Group_s
+{
+  TM1638_Handler_t *Chips;
+  uint8_t Count;
+
+  // Passed as first argument to PortWrite
+  void *Context;
+  // Write the port (NULL: pin functions of each chip)
+  void (*PortWrite)(void *Context, uint32_t SetMask, uint32_t ClearMask);
+  uint32_t ClkMask;
+  uint32_t StbMask;
+  // DIO bit of each chip (the same bit if DIO is common)
+  uint32_t DioMask[TM1638_CONFIG_GROUP_MAX_CHIPS];
+} TM1638_Group_t;
+
+
 /**
  * @brief  Data type of library functions result
+ * @note   Functions that access the bus return TM1638_BUSY without sending
+ *         anything while an asynchronous job of the handler is running. Digit
+ *         functions still update the register image in that case and their
+ *         changes are sent by the next flush.
  */
 typedef enum TM1638_Result_e
 {
   TM1638_OK      = 0,
   TM1638_FAIL    = -1,
+  TM1638_BUSY    = -2,
 } TM1638_Result_t;
 
 
@@ -146,9 +479,29 @@ TM1638_Init(TM1638_Handler_t *Handler, uint8_t Type);
  * @param  Handler: Pointer to handler
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful.
+ *         - TM1638_BUSY: An asynchronous job is running
  */
 TM1638_Result_t
 TM1638_DeInit(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Set bus timing profile
+ * @param  Handler: Pointer to handler
+ * @param  Timing: Pointer to timing profile (nanoseconds)
+ * @note   Values are converted once to CPU cycles if DelayCycles is set,
+ *         otherwise to microseconds (rounded up). A zero value removes the
+ *         delay call, which is useful when the GPIO calls themselves are
+ *         slower than the TM1638 minimum timing.
+ * @note   WriteByte, ReadByte and Transfer callbacks get the converted
+ *         profile and apply it in the same units.
+ * @note   TM1638_Init() sets the default profile (1us clock half-periods).
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful.
+ *         - TM1638_BUSY: An asynchronous job is running (timing is kept)
+ */
+TM1638_Result_t
+TM1638_SetTiming(TM1638_Handler_t *Handler, const TM1638_Timing_t *Timing);
  
 
 
@@ -177,12 +530,70 @@ TM1638_DeInit(TM1638_Handler_t *Handler);
  * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
  */
 TM1638_Result_t
 TM1638_ConfigDisplay(TM1638_Handler_t *Handler,
                      uint8_t Brightness, uint8_t DisplayState);
 
 
+/**
+ * @brief  Send changed display registers to TM1638
+ * @note   Only registers changed since the last flush are sent, one frame per
+ *         contiguous run. Nothing is sent if no register has changed.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
+ */
+TM1638_Result_t
+TM1638_Flush(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Enable or disable automatic flush
+ * @note   If auto flush is enabled (default), digit functions flush the
+ *         changed registers before returning. Otherwise they only update the
+ *         register image and TM1638_Flush() must be called.
+ * @note   It has no effect if 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled.
+ * @param  Handler: Pointer to handler
+ * @param  Enable: 0 to disable, otherwise enable
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_SetAutoFlush(TM1638_Handler_t *Handler, uint8_t Enable);
+
+
+/**
+ * @brief  Get number of register bytes that were not sent because they had
+ *         not changed
+ * @param  Handler: Pointer to handler
+ * @param  SavedBytes: Pointer to save the result
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_GetSavedBytes(TM1638_Handler_t *Handler, uint32_t *SavedBytes);
+
+
+#if (TM1638_CONFIG_DOUBLE_BUFFER)
+/**
+ * @brief  Publish the back buffer
+ * @note   The rendered back buffer becomes the front buffer and the next
+ *         TM1638_Flush() sends the registers that differ from what was shown
+ *         before. Rendering continues on a copy of the published frame.
+ * @note   It may be called from a different context than TM1638_Flush().
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Previous frame has not been flushed yet
+ */
+TM1638_Result_t
+TM1638_SwapBuffers(TM1638_Handler_t *Handler);
+#endif
+
+
 /**
  * @brief  Set data to single digit in 7-segment format
  * @param  Handler: Pointer to handler
@@ -196,6 +607,8 @@ TM1638_ConfigDisplay(TM1638_Handler_t *Handler,
  * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
  */
 TM1638_Result_t
 TM1638_SetSingleDigit(TM1638_Handler_t *Handler,
@@ -216,6 +629,8 @@ TM1638_SetSingleDigit(TM1638_Handler_t *Handler,
  * @param  Count: Number of segments to write data
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
  */
 TM1638_Result_t
 TM1638_SetMultipleDigit(TM1638_Handler_t *Handler, const uint8_t *DigitData,
@@ -235,6 +650,8 @@ TM1638_SetMultipleDigit(TM1638_Handler_t *Handler, const uint8_t *DigitData,
  * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
  */
 TM1638_Result_t
 TM1638_SetSingleDigit_HEX(TM1638_Handler_t *Handler,
@@ -257,6 +674,8 @@ TM1638_SetSingleDigit_HEX(TM1638_Handler_t *Handler,
  * @param  Count: Number of segments to write data
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
  */
 TM1638_Result_t
 TM1638_SetMultipleDigit_HEX(TM1638_Handler_t *Handler, const uint8_t *DigitData,
@@ -267,9 +686,9 @@ TM1638_SetMultipleDigit_HEX(TM1638_Handler_t *Handler, const uint8_t *DigitData,
  * @brief  Set data to multiple digits in char format
  * @param  Handler: Pointer to handler
  * @param  DigitData: Array to Digits data. 
- *                    Supported chars 0,1,2,3,4,5,6,7,8,9
- *                                    A,b,C,d,E,F,g,G,h,H,i,I,j,l,L,n,N,o,O,P,q,r,S,
- *                                    t,u,U,y,_,-,Overscore (use ~ to set)
+ *                    ASCII characters are converted by the font. With the
+ *                    default font, letters that can not be shown are blank
+ *                    and ~ shows Overscore. Bit 7 sets the decimal point.
  * 
  * @param  StartAddr: First digit position
  *         - 0: Seg1
@@ -281,12 +700,628 @@ TM1638_SetMultipleDigit_HEX(TM1638_Handler_t *Handler, const uint8_t *DigitData,
  * @param  Count: Number of segments to write data
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of range (0 to 15 for common
+ *                        cathode, 0 to 9 for common anode)
  */
 TM1638_Result_t
 TM1638_SetMultipleDigit_CHAR(TM1638_Handler_t *Handler, const uint8_t *DigitData,
                              uint8_t StartAddr, uint8_t Count);
 
 
+/**
+ * @brief  Set font used by HEX and CHAR digit functions
+ * @note   Font is a table of 128 seven-segment codes indexed by ASCII code.
+ *         Entries 0 to 15 are used for digit values 0 to 15. Bit 7 of digit
+ *         data is the decimal point and is added to the font entry.
+ * @note   The font is not copied and must remain valid. On AVR it must be
+ *         placed in program memory (PROGMEM).
+ * @param  Handler: Pointer to handler
+ * @param  Font: Pointer to font (NULL: default font)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_SetFont(TM1638_Handler_t *Handler, const uint8_t *Font);
+
+
+/**
+ * @brief  Set a signed decimal number to multiple digits
+ * @note   8, 16 and 32-bit values are converted without division. A
+ *         negative number gets a '-' before its first digit.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumber(TM1638_Handler_t *Handler, int32_t Number,
+                 uint8_t StartAddr, uint8_t Count, uint8_t Flags);
+
+
+/**
+ * @brief  Set an unsigned decimal number to multiple digits
+ * @note   8, 16 and 32-bit values are converted without division.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumberUnsigned(TM1638_Handler_t *Handler, uint32_t Number,
+                         uint8_t StartAddr, uint8_t Count, uint8_t Flags);
+
+
+/**
+ * @brief  Set a signed fixed-point number to multiple digits
+ * @note   Number is the value scaled by 10^DecimalPos, e.g. 1234 with
+ *         DecimalPos 2 shows 12.34 and 5 with DecimalPos 2 shows 0.05.
+ * @param  Handler: Pointer to handler
+ * @param  Number: Scaled number to show
+ * @param  DecimalPos: Number of digits after the decimal point
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumberFixed(TM1638_Handler_t *Handler, int32_t Number,
+                      uint8_t DecimalPos, uint8_t StartAddr, uint8_t Count,
+                      uint8_t Flags);
+
+
+/**
+ * @brief  Set an unsigned number to multiple digits in hexadecimal format
+ * @param  Handler: Pointer to handler
+ * @param  Number: Number to show
+ * @param  StartAddr: First digit position (most significant digit)
+ * @param  Count: Number of digits, the number is right-aligned
+ * @param  Flags: Zero or TM1638NumberZeroPad to fill unused digits with 0
+ *                instead of blanks
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Number does not fit (all digits show '-') or
+ *                        position is out of range
+ */
+TM1638_Result_t
+TM1638_SetNumber_HEX(TM1638_Handler_t *Handler, uint32_t Number,
+                     uint8_t StartAddr, uint8_t Count, uint8_t Flags);
+
+
+/**
+ * @brief  Set state of all discrete LEDs
+ * @note   LED n is bit 0 of register 2n+1, as on LED&KEY boards. Other bits
+ *         of LED registers and digits are not changed, so with auto flush
+ *         disabled LEDs and digits are sent in one burst by TM1638_Flush().
+ * @note   Only Common-Cathode display type is supported.
+ * @param  Handler: Pointer to handler
+ * @param  Mask: Bit n set to turn LED n on
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Display type is Common-Anode
+ */
+TM1638_Result_t
+TM1638_SetLeds(TM1638_Handler_t *Handler, uint8_t Mask);
+
+
+/**
+ * @brief  Set state of one discrete LED
+ * @note   See TM1638_SetLeds().
+ * @param  Handler: Pointer to handler
+ * @param  Index: LED number (0 to 7)
+ * @param  State: 0 to turn off, otherwise turn on
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Index is out of range or display type is
+ *                        Common-Anode
+ */
+TM1638_Result_t
+TM1638_SetLed(TM1638_Handler_t *Handler, uint8_t Index, uint8_t State);
+
+
+
+/**
+ ==================================================================================
+                         ##### Transaction Functions #####                         
+ ==================================================================================
+ */
+
+/**
+ * @brief  Begin a display transaction
+ * @note   A transaction collects raw display register writes and a display
+ *         control change. TM1638_TransactionCommit() merges the registers
+ *         into the register image and sends the data command once, one
+ *         address frame per contiguous run of changed registers and a display
+ *         control frame only if the control byte changed.
+ * @param  Handler: Pointer to handler
+ * @param  Transaction: Pointer to transaction
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_TransactionBegin(TM1638_Handler_t *Handler,
+                        TM1638_Transaction_t *Transaction);
+
+
+/**
+ * @brief  Add raw display register data to a transaction
+ * @param  Transaction: Pointer to transaction
+ * @param  Data: Array of register data
+ * @param  StartAddr: First register address (0 to 15)
+ * @param  Count: Number of registers to write
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Address range is out of 0 to 15
+ */
+TM1638_Result_t
+TM1638_TransactionWrite(TM1638_Transaction_t *Transaction, const uint8_t *Data,
+                        uint8_t StartAddr, uint8_t Count);
+
+
+/**
+ * @brief  Add display parameters to a transaction
+ * @param  Transaction: Pointer to transaction
+ * @param  Brightness: Set brightness level (0 to 7, see TM1638_ConfigDisplay)
+ * @param  DisplayState: Set display ON or OFF
+ *         - TM1638DisplayStateOFF: Set display state OFF
+ *         - TM1638DisplayStateON: Set display state ON
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_TransactionConfigDisplay(TM1638_Transaction_t *Transaction,
+                                uint8_t Brightness, uint8_t DisplayState);
+
+
+/**
+ * @brief  Send all collected changes of a transaction
+ * @note   If 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled, the registers are
+ *         written into the shown image and into both buffers. The rest of
+ *         the back buffer stays unpublished and swapping is left to the
+ *         caller. A swap requested before is sent by this commit.
+ * @note   If TM1638_BUSY is returned, nothing is sent and the transaction is
+ *         kept, so the commit can be retried.
+ * @param  Transaction: Pointer to transaction
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent)
+ */
+TM1638_Result_t
+TM1638_TransactionCommit(TM1638_Transaction_t *Transaction);
+
+
+
+/**
+ ==================================================================================
+                       ##### Virtual Display Functions #####                       
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a virtual display
+ * @param  Virtual: Pointer to virtual display
+ * @param  Chips: Array of initialized handlers, first one shows digit 0
+ * @param  Count: Number of handlers
+ * @param  DigitsPerChip: Number of digits of each chip
+ * @param  PositionStep: Distance of digit positions of a chip (1 or 2)
+ *         - 1: Digits are on positions 0, 1, 2, ...
+ *         - 2: Digits are on positions 0, 2, 4, ... (e.g. LEDs on odd ones)
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count, DigitsPerChip or PositionStep is 0
+ */
+TM1638_Result_t
+TM1638_VirtualInit(TM1638_Virtual_t *Virtual, TM1638_Handler_t *Chips,
+                   uint8_t Count, uint8_t DigitsPerChip, uint8_t PositionStep);
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in 7-segment format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                              uint8_t StartDigit, uint8_t Count);
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in hexadecimal format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ *                    (0, 1, ... , 15, a, A, b, B, ... , f, F)
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit_HEX(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                                  uint8_t StartDigit, uint8_t Count);
+
+
+/**
+ * @brief  Set data to multiple digits of virtual display in char format
+ * @note   Only the chips covered by the digits are written, each one is
+ *         flushed once if its auto flush is enabled.
+ * @param  Virtual: Pointer to virtual display
+ * @param  DigitData: Array to Digits data.
+ *                    (see TM1638_SetMultipleDigit_CHAR)
+ * @param  StartDigit: First logical digit
+ * @param  Count: Number of digits to write data
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Digits are out of the virtual display
+ */
+TM1638_Result_t
+TM1638_VirtualSetMultipleDigit_CHAR(TM1638_Virtual_t *Virtual, const uint8_t *DigitData,
+                                   uint8_t StartDigit, uint8_t Count);
+
+
+/**
+ * @brief  Send changed display registers of all chips of virtual display
+ * @param  Virtual: Pointer to virtual display
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_VirtualFlush(TM1638_Virtual_t *Virtual);
+
+
+
+/**
+ ==================================================================================
+                           ##### Marquee Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize scrolling text and show its first window
+ * @note   Text is converted to 7-segment format once and saved in Buffer.
+ *         Text and Buffer can be the same array. Buffer must remain valid
+ *         while the marquee is used.
+ * @note   The marquee starts with Speed 1, no pause, forward and without wrap.
+ *         Text that is not longer than the window is shown without scrolling.
+ * @param  Marquee: Pointer to marquee
+ * @param  Handler: Pointer to handler
+ * @param  Buffer: Array of Length bytes to save encoded text
+ * @param  Text: Text in char format (see TM1638_SetMultipleDigit_CHAR)
+ * @param  Length: Length of text
+ * @param  StartAddr: First digit position of the window
+ * @param  Count: Number of digits of the window
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Length or Count is 0 or window is out of range
+ */
+TM1638_Result_t
+TM1638_MarqueeInit(TM1638_Marquee_t *Marquee, TM1638_Handler_t *Handler,
+                   uint8_t *Buffer, const uint8_t *Text, uint8_t Length,
+                   uint8_t StartAddr, uint8_t Count);
+
+
+/**
+ * @brief  Configure scrolling and restart from the first window
+ * @param  Marquee: Pointer to marquee
+ * @param  Speed: Number of ticks per step (0 is taken as 1)
+ * @param  Pause: Extra ticks to stay at the start and end of text
+ * @param  Flags: Combination of
+ *         - TM1638MarqueeReverse: Text moves right instead of left
+ *         - TM1638MarqueeWrap: Text scrolls as a ring, after its last
+ *                              character the first one follows. Otherwise
+ *                              it stops at the end and restarts.
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Window could not be drawn
+ *         - TM1638_BUSY: An asynchronous job is running (window is drawn
+ *                        and sent by the next flush)
+ */
+TM1638_Result_t
+TM1638_MarqueeConfig(TM1638_Marquee_t *Marquee,
+                     uint8_t Speed, uint8_t Pause, uint8_t Flags);
+
+
+/**
+ * @brief  Advance scrolling text
+ * @note   It should be called periodically. On each step only the window is
+ *         written to the register image, without encoding the text again.
+ * @note   If the step can not be drawn or flushed, the position is kept and
+ *         the step is retried on the next call.
+ * @param  Marquee: Pointer to marquee
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Window could not be drawn
+ *         - TM1638_BUSY: An asynchronous job is running
+ */
+TM1638_Result_t
+TM1638_MarqueeTick(TM1638_Marquee_t *Marquee);
+
+
+
+/**
+ ==================================================================================
+                          ##### Animation Functions #####                          
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start an animation and show its first frame
+ * @note   Frames are not copied and must remain valid. On AVR they must be
+ *         placed in program memory (PROGMEM).
+ * @note   Registers not selected by Mask are left to other digit functions,
+ *         e.g. an animated digit next to a number.
+ * @param  Animation: Pointer to animation
+ * @param  Handler: Pointer to handler
+ * @param  Frames: Array of frames
+ * @param  Count: Number of frames
+ * @param  Mask: Bit n set to let the animation write register n
+ * @param  Loop: 0 to stop on the last frame, otherwise start over
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count is 0
+ */
+TM1638_Result_t
+TM1638_AnimationStart(TM1638_Animation_t *Animation, TM1638_Handler_t *Handler,
+                      const TM1638_Frame_t *Frames, uint8_t Count,
+                      uint16_t Mask, uint8_t Loop);
+
+
+/**
+ * @brief  Stop an animation, the current frame stays on display
+ * @param  Animation: Pointer to animation
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_AnimationStop(TM1638_Animation_t *Animation);
+
+
+/**
+ * @brief  Advance an animation
+ * @note   It should be called periodically. When the next frame is due, only
+ *         its registers that differ from the register image are marked to
+ *         be sent.
+ * @param  Animation: Pointer to animation
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_AnimationTick(TM1638_Animation_t *Animation);
+
+
+
+/**
+ ==================================================================================
+                            ##### Fade Functions #####                             
+ ==================================================================================
+ */
+
+/**
+ * @brief  Start a brightness fade from the current level
+ * @note   Current level is taken from the last display control command.
+ * @note   Curve is not copied and must remain valid. On AVR it must be placed
+ *         in program memory (PROGMEM).
+ * @param  Fade: Pointer to fade
+ * @param  Handler: Pointer to handler
+ * @param  Level: Target level
+ *         - 0: Display OFF
+ *         - 1 to 8: Display ON with brightness 0 to 7
+ * 
+ * @param  Duration: Number of ticks to reach the target level
+ * @param  Curve: Easing table, entries from 0 (start) to 255 (target) over
+ *                the fade time. NULL for linear fade.
+ * @param  CurveLength: Number of entries of Curve (at least 2)
+ * @param  Mode: Behavior at the end of fade
+ *         - TM1638FadeOnce: Stay at the target level
+ *         - TM1638FadeRepeat: Start over from the start level
+ *         - TM1638FadePulse: Fade back and forth between the two levels
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Level or CurveLength is out of range
+ */
+TM1638_Result_t
+TM1638_FadeStart(TM1638_Fade_t *Fade, TM1638_Handler_t *Handler,
+                 uint8_t Level, uint16_t Duration,
+                 const uint8_t *Curve, uint8_t CurveLength, uint8_t Mode);
+
+
+/**
+ * @brief  Stop a fade, the current level is kept
+ * @param  Fade: Pointer to fade
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_FadeStop(TM1638_Fade_t *Fade);
+
+
+/**
+ * @brief  Advance a fade
+ * @note   It should be called periodically. A display control command is
+ *         sent only if the level changes.
+ * @param  Fade: Pointer to fade
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (try again later)
+ */
+TM1638_Result_t
+TM1638_FadeTick(TM1638_Fade_t *Fade);
+
+
+
+#if (TM1638_CONFIG_DIMMING)
+/**
+ ==================================================================================
+                           ##### Dimming Functions #####                           
+ ==================================================================================
+ */
+
+/**
+ * @brief  Set brightness of one digit relative to the display brightness
+ * @note   The digit is shown in Level of every TM1638_CONFIG_DIM_STEPS calls
+ *         of TM1638_DimTick(), spread evenly over the cycle. All digits start
+ *         at full level.
+ * @note   On Common-Cathode displays each position is one register, so LEDs
+ *         (usually on odd positions) can be dimmed too.
+ * @param  Handler: Pointer to handler
+ * @param  DigitPos: Digit position
+ *         - 0: Seg1
+ *         - 1: Seg2
+ *         - .
+ *         - .
+ *         - .
+ * 
+ * @param  Level: 0 (off) to TM1638_CONFIG_DIM_STEPS (full)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: DigitPos or Level is out of range
+ */
+TM1638_Result_t
+TM1638_SetDigitLevel(TM1638_Handler_t *Handler, uint8_t DigitPos, uint8_t Level);
+
+
+/**
+ * @brief  Advance the dimming cycle and flush
+ * @note   It should be called periodically, fast enough to avoid flicker
+ *         (e.g. every 2ms with 4 steps). Only registers whose shown value
+ *         changes are sent.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (nothing is sent and
+ *                        the step is not advanced)
+ */
+TM1638_Result_t
+TM1638_DimTick(TM1638_Handler_t *Handler);
+#endif
+
+
+
+#if (TM1638_CONFIG_GROUP)
+/**
+ ==================================================================================
+                            ##### Group Functions #####                            
+ ==================================================================================
+ */
+
+/**
+ * @brief  Initialize a group of TM1638s refreshed together
+ * @note   The group starts in pin mode: frames are clocked into all chips
+ *         at once through the pin functions of each chip, which needs a
+ *         separate DIO line per chip. Port layer (or user) can set PortWrite,
+ *         Context, ClkMask, StbMask and DioMask afterwards to write all pins
+ *         of a clock edge at once. Without PortWrite, give chips on a common
+ *         DIO line the same nonzero DioMask to make the group flush them one
+ *         by one (separate STB lines needed).
+ * @param  Group: Pointer to group
+ * @param  Chips: Array of initialized handlers
+ * @param  Count: Number of handlers (1 to 'TM1638_CONFIG_GROUP_MAX_CHIPS')
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Count is out of range
+ */
+TM1638_Result_t
+TM1638_GroupInit(TM1638_Group_t *Group, TM1638_Handler_t *Chips, uint8_t Count);
+
+
+/**
+ * @brief  Send changed display registers of all chips of the group
+ * @note   If each chip has its own DIO line, the union of changed registers
+ *         of all chips is sent in parallel, so all chips are refreshed in the
+ *         time of one. Otherwise (common DIO or a chip with Transfer)
+ *         TM1638_Flush() is called for each chip, which needs a separate STB
+ *         line per chip.
+ * @note   Disable auto flush of the chips to draw into them without sending.
+ * @param  Group: Pointer to group
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_GroupFlush(TM1638_Group_t *Group);
+
+
+/**
+ * @brief  Config display of all chips of the group
+ * @note   STB of all chips is lowered together and the command is sent once.
+ *         If a chip uses Transfer and PortWrite is not set,
+ *         TM1638_ConfigDisplay() is called for each chip instead.
+ * @param  Group: Pointer to group
+ * @param  Brightness: Set brightness level
+ *         - 0: Display pulse width is set as 1/16
+ *         - 1: Display pulse width is set as 2/16
+ *         - 2: Display pulse width is set as 4/16
+ *         - 3: Display pulse width is set as 10/16
+ *         - 4: Display pulse width is set as 11/16
+ *         - 5: Display pulse width is set as 12/16
+ *         - 6: Display pulse width is set as 13/16
+ *         - 7: Display pulse width is set as 14/16
+ * 
+ * @param  DisplayState: Set display ON or OFF
+ *         - TM1638DisplayStateOFF: Set display state OFF
+ *         - TM1638DisplayStateON: Set display state ON
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_GroupConfigDisplay(TM1638_Group_t *Group,
+                          uint8_t Brightness, uint8_t DisplayState);
+
+
+/**
+ * @brief  Write the same display registers to all chips of the group
+ * @note   Useful for clears and test patterns. STB of all chips is lowered
+ *         together and the registers are sent once. If a chip uses Transfer
+ *         and PortWrite is not set, they are sent to each chip instead.
+ *         Register images of all chips are updated, including both buffers
+ *         if 'TM1638_CONFIG_DOUBLE_BUFFER' is enabled, so the registers stay
+ *         until they are drawn again.
+ * @param  Group: Pointer to group
+ * @param  Data: Register data
+ * @param  StartAddr: First register address (0 to 15)
+ * @param  Count: Number of registers
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_FAIL: Address range is out of 0 to 15
+ *         - TM1638_BUSY: An asynchronous job of a chip is running
+ */
+TM1638_Result_t
+TM1638_GroupWriteAll(TM1638_Group_t *Group, const uint8_t *Data,
+                     uint8_t StartAddr, uint8_t Count);
+#endif
+
+
 
 /** 
  ==================================================================================
@@ -311,11 +1346,129 @@ TM1638_SetMultipleDigit_CHAR(TM1638_Handler_t *Handler, const uint8_t *DigitData
  * 
  * @retval TM1638_Result_t
  *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (keys are not read)
  */
 TM1638_Result_t
 TM1638_ScanKeys(TM1638_Handler_t *Handler, uint32_t *Keys);
 
 
+/**
+ * @brief  Read key scan data registers without decoding
+ * @param  Handler: Pointer to handler
+ * @param  KeyRegs: Array of 4 bytes to save BYTE1 to BYTE4 of key scan data
+ *         - bit0=>K3_SEG(2n+1), bit1=>K2_SEG(2n+1), bit2=>K1_SEG(2n+1),
+ *         - bit4=>K3_SEG(2n+2), bit5=>K2_SEG(2n+2), bit6=>K1_SEG(2n+2)
+ *           for KeyRegs[n]
+ * 
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: An asynchronous job is running (keys are not read)
+ */
+TM1638_Result_t
+TM1638_ScanKeysRaw(TM1638_Handler_t *Handler, uint8_t *KeyRegs);
+
+
+/**
+ * @brief  Initialize a key debouncer with all keys released
+ * @param  Debounce: Pointer to debouncer
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_DebounceInit(TM1638_Debounce_t *Debounce);
+
+
+/**
+ * @brief  Debounce a key scan result
+ * @note   A key changes its stable state after it is read in the new state
+ *         in 4 scans in a row. All 24 keys are processed together by a few
+ *         bitwise operations. Pressed and Released of the debouncer are set
+ *         to the keys that changed in this call.
+ * @param  Debounce: Pointer to debouncer
+ * @param  Keys: Key scan result (see TM1638_ScanKeys)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ */
+TM1638_Result_t
+TM1638_DebounceUpdate(TM1638_Debounce_t *Debounce, uint32_t Keys);
+
+
+
+#if (TM1638_CONFIG_ASYNC)
+/**
+ ==================================================================================
+                        ##### Asynchronous Functions #####                         
+ ==================================================================================
+ */
+
+/**
+ * @brief  Queue a flush of changed display registers
+ * @note   The job is built from the register image when queued and is sent
+ *         by TM1638_Poll() or TM1638_TimerTick(). Blocking bus functions
+ *         return TM1638_BUSY while the job is running.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Job queued
+ *         - TM1638_BUSY: Another job is running
+ */
+TM1638_Result_t
+TM1638_FlushAsync(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Queue a key scan
+ * @note   Use TM1638_GetAsyncKeys() to get the result after completion.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Job queued
+ *         - TM1638_BUSY: Another job is running
+ */
+TM1638_Result_t
+TM1638_ScanKeysAsync(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Advance the running job
+ * @note   Each call clocks at most 'TM1638_CONFIG_ASYNC_BITS_PER_POLL' bits
+ *         (or one whole frame if Transfer callback is used). AsyncDone
+ *         callback is called when the job completes.
+ * @note   If TimerStart callback is set, it only returns the job state.
+ * @param  Handler: Pointer to handler
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: No job is running (completed)
+ *         - TM1638_BUSY: Job is still running
+ */
+TM1638_Result_t
+TM1638_Poll(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Advance the running job by one clock half-period
+ * @note   Call it from the timer interrupt started by TimerStart callback.
+ *         Bus delays are not applied, so the timer period sets the clock
+ *         half-period and must be at least 1us (read wait of TM1638).
+ *         TimerStop and AsyncDone callbacks are called from this function
+ *         when the job completes.
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+TM1638_TimerTick(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Get result of the last completed asynchronous key scan
+ * @param  Handler: Pointer to handler
+ * @param  Keys: pointer to save key scan result (see TM1638_ScanKeys)
+ * @retval TM1638_Result_t
+ *         - TM1638_OK: Operation was successful
+ *         - TM1638_BUSY: A job is running
+ */
+TM1638_Result_t
+TM1638_GetAsyncKeys(TM1638_Handler_t *Handler, uint32_t *Keys);
+#endif
+
+
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,464 @@
+/**
+ **********************************************************************************
+ * @file   TM1638_mock.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Host mock of TM1638 for tests
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Includes ---------------------------------------------------------------------*/
+#include "TM1638_mock.h"
+#include <string.h>
+
+
+/* Exported Variables -----------------------------------------------------------*/
+int Test_Failures = 0;
+
+
+/* Private variables ------------------------------------------------------------*/
+// Frames beyond MOCK_MAX_FRAMES are decoded here and not recorded
+static Mock_Frame_t Mock_Overflow;
+
+
+
+/**
+ ==================================================================================
+                           ##### Private Functions #####
+ ==================================================================================
+ */
+
+static Mock_Frame_t *
+Mock_Frame(Mock_Chip_t *Chip)
+{
+  if (Chip->NumFrames == 0 || Chip->Count.Frames > MOCK_MAX_FRAMES)
+    return &Mock_Overflow;
+
+  return &Chip->Frames[Chip->NumFrames - 1];
+}
+
+static void
+Mock_FrameBegin(Mock_Chip_t *Chip)
+{
+  Chip->Count.Frames++;
+  if (Chip->NumFrames < MOCK_MAX_FRAMES)
+    Chip->NumFrames++;
+  memset(Mock_Frame(Chip), 0, sizeof(Mock_Frame_t));
+
+  Chip->Shift = 0;
+  Chip->Bits = 0;
+  Chip->Reading = 0;
+  Chip->ReadBits = 0;
+}
+
+static void
+Mock_FrameEnd(Mock_Chip_t *Chip)
+{
+  // A frame must end on a byte boundary
+  if (Chip->Bits || (Chip->ReadBits % 8))
+    Chip->Errors++;
+
+  Chip->Reading = 0;
+}
+
+static void
+Mock_ChipWrite(Mock_Chip_t *Chip, uint8_t Data)
+{
+  Mock_Frame_t *Frame = Mock_Frame(Chip);
+
+  if (Frame->Length < MOCK_MAX_BYTES)
+    Frame->Data[Frame->Length] = Data;
+  Frame->Length++;
+
+  if (Chip->Reading)
+  {
+    Chip->Errors++;
+    return;
+  }
+
+  if (Frame->Length > 1)
+  {
+    Chip->Ram[Chip->Address] = Data;
+    if (!Chip->Fixed)
+      Chip->Address = (Chip->Address + 1) & 0x0F;
+    return;
+  }
+
+  switch (Data & 0xC0)
+  {
+  case 0x40:
+    Chip->Fixed = (Data & 0x04) ? 1 : 0;
+    Chip->Reading = (Data & 0x02) ? 1 : 0;
+    break;
+
+  case 0x80:
+    Chip->Control = Data;
+    break;
+
+  case 0xC0:
+    Chip->Address = Data & 0x0F;
+    break;
+
+  default:
+    Chip->Errors++;
+    break;
+  }
+}
+
+static uint8_t
+Mock_ChipKeyBit(Mock_Chip_t *Chip)
+{
+  uint8_t Bit = Chip->ReadBits++;
+
+  if (Bit >= 32)
+    return 1;
+
+  return (Chip->Keys[Bit >> 3] >> (Bit & 7)) & 0x01;
+}
+
+
+void
+Mock_DioConfigOut(void *Context)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.DioConfig++;
+  Chip->DioOut = 1;
+}
+
+void
+Mock_DioConfigIn(void *Context)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.DioConfig++;
+  Chip->DioOut = 0;
+}
+
+void
+Mock_DioWrite(void *Context, uint8_t Level)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.DioWrite++;
+  if (!Chip->DioOut)
+    Chip->Errors++;
+  Chip->Dio = Level ? 1 : 0;
+}
+
+uint8_t
+Mock_DioRead(void *Context)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.DioRead++;
+  if (Chip->DioOut || !Chip->Reading)
+    Chip->Errors++;
+
+  return Chip->ChipDio;
+}
+
+void
+Mock_ClkWrite(void *Context, uint8_t Level)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Level = Level ? 1 : 0;
+  Chip->Count.ClkWrite++;
+
+  if (Chip->Stb == 0 && Level != Chip->Clk)
+  {
+    if (Level)
+    {
+      Chip->Count.ClkEdges++;
+      if (!Chip->Reading)
+      {
+        // TM1638 latches DIO on the rising edge
+        if (!Chip->DioOut)
+          Chip->Errors++;
+        Chip->Shift |= (uint8_t)(Chip->Dio << Chip->Bits);
+        if (++Chip->Bits == 8)
+        {
+          Mock_ChipWrite(Chip, Chip->Shift);
+          Chip->Shift = 0;
+          Chip->Bits = 0;
+        }
+      }
+    }
+    else if (Chip->Reading)
+    {
+      // and shifts key data out on the falling edge
+      Chip->ChipDio = Mock_ChipKeyBit(Chip);
+      if ((Chip->ReadBits & 7) == 0)
+        Mock_Frame(Chip)->Read++;
+    }
+  }
+
+  Chip->Clk = Level;
+}
+
+void
+Mock_StbWrite(void *Context, uint8_t Level)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Level = Level ? 1 : 0;
+  Chip->Count.StbWrite++;
+
+  if (Level == 0 && Chip->Stb == 1)
+    Mock_FrameBegin(Chip);
+  else if (Level == 1 && Chip->Stb == 0)
+    Mock_FrameEnd(Chip);
+
+  Chip->Stb = Level;
+}
+
+static void
+Mock_DelayUs(void *Context, uint8_t Delay)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.Delay++;
+  Chip->Count.DelayTotal += Delay;
+
+  // Only the wait after DIO is released counts, not the last command clock
+  if (Chip->Stb == 0 && Chip->Reading && !Chip->DioOut && Chip->ReadBits == 0)
+    Mock_Frame(Chip)->Wait += Delay;
+}
+
+static void
+Mock_ByteDelay(Mock_Chip_t *Chip, const TM1638_Timing_t *Delay)
+{
+  // Bit delays of the port are not calls of the library, only their time
+  Chip->Count.DelayTotal += 8U * Delay->ClkLow + 8U * Delay->ClkHigh;
+}
+
+static void
+Mock_WriteByte(void *Context, uint8_t Data, const TM1638_Timing_t *Delay)
+{
+  Mock_Chip_t *Chip = Context;
+
+  Chip->Count.WriteByte++;
+  if (Chip->Stb || !Chip->DioOut || Chip->Reading || Chip->Bits)
+    Chip->Errors++;
+
+  Chip->Count.ClkEdges += 8;
+  Mock_ByteDelay(Chip, Delay);
+  Mock_ChipWrite(Chip, Data);
+}
+
+static uint8_t
+Mock_ReadByte(void *Context, const TM1638_Timing_t *Delay)
+{
+  Mock_Chip_t *Chip = Context;
+  uint8_t i, Data = 0;
+
+  Chip->Count.ReadByte++;
+  if (Chip->Stb || Chip->DioOut || !Chip->Reading || (Chip->ReadBits & 7))
+    Chip->Errors++;
+
+  Chip->Count.ClkEdges += 8;
+  Mock_ByteDelay(Chip, Delay);
+  for (i = 0; i < 8; i++)
+    Data |= (uint8_t)(Mock_ChipKeyBit(Chip) << i);
+  Mock_Frame(Chip)->Read++;
+
+  return Data;
+}
+
+static void
+Mock_Transfer(void *Context, uint8_t Command,
+              const uint8_t *TxData, uint8_t TxLen,
+              uint8_t *RxData, uint8_t RxLen,
+              const TM1638_Timing_t *Delay)
+{
+  Mock_Chip_t *Chip = Context;
+  uint8_t i, j;
+
+  Chip->Count.Transfer++;
+
+  Mock_FrameBegin(Chip);
+  Mock_ChipWrite(Chip, Command);
+  for (i = 0; i < TxLen; i++)
+    Mock_ChipWrite(Chip, TxData[i]);
+
+  if (RxLen)
+  {
+    if (!Chip->Reading)
+      Chip->Errors++;
+    Mock_Frame(Chip)->Wait = Delay->ReadWait;
+  }
+
+  for (i = 0; i < RxLen; i++)
+  {
+    for (j = 0, RxData[i] = 0; j < 8; j++)
+      RxData[i] |= (uint8_t)(Mock_ChipKeyBit(Chip) << j);
+    Mock_Frame(Chip)->Read++;
+  }
+  Mock_FrameEnd(Chip);
+}
+
+static void
+Mock_Nop(void *Context)
+{
+  (void)Context;
+}
+
+
+
+/**
+ ==================================================================================
+                             ##### Mock Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Reset the mock chip and bind it to the GPIO callbacks of handler
+ * @note   All handler fields are cleared first.
+ * @param  Chip: Pointer to mock chip
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+Mock_Init(Mock_Chip_t *Chip, TM1638_Handler_t *Handler)
+{
+  memset(Chip, 0, sizeof(Mock_Chip_t));
+  Chip->Stb = 1;
+  Chip->Clk = 1;
+  Chip->Dio = 1;
+  Chip->ChipDio = 1;
+
+  memset(Handler, 0, sizeof(TM1638_Handler_t));
+  Handler->Context = Chip;
+  Handler->PlatformInit = Mock_Nop;
+  Handler->PlatformDeInit = Mock_Nop;
+  Handler->DioConfigOut = Mock_DioConfigOut;
+  Handler->DioConfigIn = Mock_DioConfigIn;
+  Handler->DioWrite = Mock_DioWrite;
+  Handler->DioRead = Mock_DioRead;
+  Handler->ClkWrite = Mock_ClkWrite;
+  Handler->StbWrite = Mock_StbWrite;
+  Handler->DelayUs = Mock_DelayUs;
+}
+
+
+/**
+ * @brief  Use the WriteByte and ReadByte callbacks of mock for data bits
+ * @param  Handler: Pointer to handler bound by Mock_Init()
+ * @retval None
+ */
+void
+Mock_UseByteIO(TM1638_Handler_t *Handler)
+{
+  Handler->WriteByte = Mock_WriteByte;
+  Handler->ReadByte = Mock_ReadByte;
+}
+
+
+/**
+ * @brief  Use the Transfer callback of mock instead of GPIO callbacks
+ * @param  Handler: Pointer to handler bound by Mock_Init()
+ * @retval None
+ */
+void
+Mock_UseTransfer(TM1638_Handler_t *Handler)
+{
+  Handler->DioConfigOut = NULL;
+  Handler->DioConfigIn = NULL;
+  Handler->DioWrite = NULL;
+  Handler->DioRead = NULL;
+  Handler->ClkWrite = NULL;
+  Handler->StbWrite = NULL;
+  Handler->Transfer = Mock_Transfer;
+}
+
+
+/**
+ * @brief  Clear recorded frames and counters, chip state is kept
+ * @param  Chip: Pointer to mock chip
+ * @retval None
+ */
+void
+Mock_Clear(Mock_Chip_t *Chip)
+{
+  memset(Chip->Frames, 0, sizeof(Chip->Frames));
+  memset(&Chip->Count, 0, sizeof(Chip->Count));
+  Chip->NumFrames = 0;
+  Chip->Errors = 0;
+}
+
+
+/**
+ * @brief  Compare recorded frames of two mock chips
+ * @param  A: Pointer to first mock chip
+ * @param  B: Pointer to second mock chip
+ * @retval 1 if frames are the same, otherwise 0
+ */
+int
+Mock_SameFrames(const Mock_Chip_t *A, const Mock_Chip_t *B)
+{
+  uint8_t i;
+
+  if (A->Count.Frames != B->Count.Frames)
+    return 0;
+
+  for (i = 0; i < A->NumFrames; i++)
+  {
+    const Mock_Frame_t *FA = &A->Frames[i];
+    const Mock_Frame_t *FB = &B->Frames[i];
+
+    if (FA->Length != FB->Length || FA->Read != FB->Read ||
+        FA->Wait != FB->Wait ||
+        memcmp(FA->Data, FB->Data,
+               FA->Length < MOCK_MAX_BYTES ? FA->Length : MOCK_MAX_BYTES))
+      return 0;
+  }
+
+  return 1;
+}
+
+
+/**
+ * @brief  Print recorded frames, e.g. "[40][C0 3F 06][42 r4]"
+ * @param  Chip: Pointer to mock chip
+ * @retval None
+ */
+void
+Mock_PrintFrames(const Mock_Chip_t *Chip)
+{
+  uint8_t i, j;
+
+  for (i = 0; i < Chip->NumFrames; i++)
+  {
+    const Mock_Frame_t *Frame = &Chip->Frames[i];
+
+    printf("[");
+    for (j = 0; j < Frame->Length && j < MOCK_MAX_BYTES; j++)
+      printf(j ? " %02X" : "%02X", Frame->Data[j]);
+    if (Frame->Read)
+      printf(" r%u", Frame->Read);
+    printf("]");
+  }
+  printf("\n");
+}
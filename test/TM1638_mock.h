@@ -0,0 +1,228 @@
+/**
+ **********************************************************************************
+ * @file   TM1638_mock.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Host mock of TM1638 for tests
+ *         Functionalities of the this file:
+ *          + Bit-level TM1638 model behind the GPIO callbacks
+ *          + Byte-level model behind the WriteByte/ReadByte callbacks
+ *          + Frame-level model behind the Transfer callback
+ *          + Frame recording and callback counters
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _TM1638_MOCK_H_
+#define _TM1638_MOCK_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stdio.h>
+#include "TM1638.h"
+
+
+/* Exported Constants -----------------------------------------------------------*/
+#define MOCK_MAX_FRAMES   64
+#define MOCK_MAX_BYTES    24
+
+
+/* Exported Data Types ----------------------------------------------------------*/
+/**
+ * @brief  One STB frame as seen by the chip
+ */
+typedef struct Mock_Frame_s
+{
+  // Bytes written to the chip, command byte first
+  uint8_t Data[MOCK_MAX_BYTES];
+  uint8_t Length;
+  // Number of bytes read from the chip
+  uint8_t Read;
+  // Delay between releasing DIO and the first read clock (DelayUs units)
+  uint16_t Wait;
+} Mock_Frame_t;
+
+/**
+ * @brief  Number of calls and bus events
+ */
+typedef struct Mock_Counters_s
+{
+  uint32_t DioConfig;
+  uint32_t DioWrite;
+  uint32_t DioRead;
+  uint32_t ClkWrite;
+  uint32_t StbWrite;
+  uint32_t Delay;
+  uint32_t DelayTotal;
+  uint32_t WriteByte;
+  uint32_t ReadByte;
+  uint32_t Transfer;
+  // Rising CLK edges inside frames
+  uint32_t ClkEdges;
+  // All frames, also the ones not recorded
+  uint32_t Frames;
+} Mock_Counters_t;
+
+/**
+ * @brief  Mock chip, used as Context of the handler
+ */
+typedef struct Mock_Chip_s
+{
+  // Key registers returned by the read command (set by test)
+  uint8_t Keys[4];
+
+  // Chip state
+  uint8_t Ram[16];
+  uint8_t Control;
+  uint8_t Address;
+  uint8_t Fixed;
+
+  // Bus state
+  uint8_t Stb;
+  uint8_t Clk;
+  uint8_t Dio;
+  uint8_t DioOut;
+  uint8_t ChipDio;
+  uint8_t Shift;
+  uint8_t Bits;
+  uint8_t Reading;
+  uint8_t ReadBits;
+
+  // Recorded frames and counters
+  Mock_Frame_t Frames[MOCK_MAX_FRAMES];
+  uint8_t NumFrames;
+  Mock_Counters_t Count;
+  // Protocol violations (e.g. DIO written while it is an input)
+  uint32_t Errors;
+} Mock_Chip_t;
+
+
+/* Exported Variables -----------------------------------------------------------*/
+extern int Test_Failures;
+
+
+/* Exported Macros --------------------------------------------------------------*/
+#define TEST_CHECK(Cond)                                                \
+  do                                                                    \
+  {                                                                     \
+    if (!(Cond))                                                        \
+    {                                                                   \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #Cond);   \
+      Test_Failures++;                                                  \
+    }                                                                   \
+  } while (0)
+
+#define TEST_RESULT()                                                   \
+  (printf("%s: %s\n", __FILE__, Test_Failures ? "FAIL" : "OK"),         \
+   Test_Failures != 0)
+
+
+
+/**
+ ==================================================================================
+                             ##### Mock Functions #####
+ ==================================================================================
+ */
+
+/**
+ * @brief  Reset the mock chip and bind it to the GPIO callbacks of handler
+ * @note   All handler fields are cleared first.
+ * @param  Chip: Pointer to mock chip
+ * @param  Handler: Pointer to handler
+ * @retval None
+ */
+void
+Mock_Init(Mock_Chip_t *Chip, TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  GPIO callbacks of mock, Context is the mock chip
+ * @note   Mock_Init() installs them in the handler. Static pin functions of
+ *         test/static/TM1638_platform.h call them directly.
+ */
+void Mock_DioConfigOut(void *Context);
+void Mock_DioConfigIn(void *Context);
+void Mock_DioWrite(void *Context, uint8_t Level);
+uint8_t Mock_DioRead(void *Context);
+void Mock_ClkWrite(void *Context, uint8_t Level);
+void Mock_StbWrite(void *Context, uint8_t Level);
+
+
+/**
+ * @brief  Use the WriteByte and ReadByte callbacks of mock for data bits
+ * @param  Handler: Pointer to handler bound by Mock_Init()
+ * @retval None
+ */
+void
+Mock_UseByteIO(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Use the Transfer callback of mock instead of GPIO callbacks
+ * @param  Handler: Pointer to handler bound by Mock_Init()
+ * @retval None
+ */
+void
+Mock_UseTransfer(TM1638_Handler_t *Handler);
+
+
+/**
+ * @brief  Clear recorded frames and counters, chip state is kept
+ * @param  Chip: Pointer to mock chip
+ * @retval None
+ */
+void
+Mock_Clear(Mock_Chip_t *Chip);
+
+
+/**
+ * @brief  Compare recorded frames of two mock chips
+ * @param  A: Pointer to first mock chip
+ * @param  B: Pointer to second mock chip
+ * @retval 1 if frames are the same, otherwise 0
+ */
+int
+Mock_SameFrames(const Mock_Chip_t *A, const Mock_Chip_t *B);
+
+
+/**
+ * @brief  Print recorded frames, e.g. "[40][C0 3F 06][42 r4]"
+ * @param  Chip: Pointer to mock chip
+ * @retval None
+ */
+void
+Mock_PrintFrames(const Mock_Chip_t *Chip);
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _TM1638_MOCK_H_
@@ -0,0 +1,149 @@
+/**
+ **********************************************************************************
+ * @file   TM1638_platform.h
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Static pin functions of host tests (TM1638_CONFIG_STATIC_PINS)
+ * @note   Pins are bound to the mock chip Mock_StaticChip at compile time.
+ *         If MOCK_STATIC_PORT is defined, they write a port register model
+ *         instead (code size comparison of 'make size').
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+/* Define to prevent recursive inclusion ----------------------------------------*/
+#ifndef _TM1638_PLATFORM_H_
+#define _TM1638_PLATFORM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/* Includes ---------------------------------------------------------------------*/
+#include "TM1638_mock.h"
+
+
+/* Exported Variables -----------------------------------------------------------*/
+// Defined by the test
+extern Mock_Chip_t Mock_StaticChip;
+extern volatile uint8_t Mock_Port;
+extern volatile uint8_t Mock_PortDir;
+
+
+/* Static Pin Functions ---------------------------------------------------------*/
+#if defined(MOCK_STATIC_PORT)
+#define MOCK_DIO  0x01
+#define MOCK_CLK  0x02
+#define MOCK_STB  0x04
+
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  Mock_PortDir |= MOCK_DIO;
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  Mock_PortDir &= ~MOCK_DIO;
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  if (Level)
+    Mock_Port |= MOCK_DIO;
+  else
+    Mock_Port &= ~MOCK_DIO;
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return (Mock_Port & MOCK_DIO) ? 1 : 0;
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  if (Level)
+    Mock_Port |= MOCK_CLK;
+  else
+    Mock_Port &= ~MOCK_CLK;
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  if (Level)
+    Mock_Port |= MOCK_STB;
+  else
+    Mock_Port &= ~MOCK_STB;
+}
+#else
+static inline void
+TM1638_Static_DioConfigOut(void)
+{
+  Mock_DioConfigOut(&Mock_StaticChip);
+}
+
+static inline void
+TM1638_Static_DioConfigIn(void)
+{
+  Mock_DioConfigIn(&Mock_StaticChip);
+}
+
+static inline void
+TM1638_Static_DioWrite(uint8_t Level)
+{
+  Mock_DioWrite(&Mock_StaticChip, Level);
+}
+
+static inline uint8_t
+TM1638_Static_DioRead(void)
+{
+  return Mock_DioRead(&Mock_StaticChip);
+}
+
+static inline void
+TM1638_Static_ClkWrite(uint8_t Level)
+{
+  Mock_ClkWrite(&Mock_StaticChip, Level);
+}
+
+static inline void
+TM1638_Static_StbWrite(uint8_t Level)
+{
+  Mock_StbWrite(&Mock_StaticChip, Level);
+}
+#endif
+
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif //! _TM1638_PLATFORM_H_
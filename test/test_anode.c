@@ -0,0 +1,154 @@
+/**
+ **********************************************************************************
+ * @file   test_anode.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Common-anode transpose against the per-bit loop it replaced
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include <time.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+#define CASES       200000
+#define BENCH_RUNS  1000000
+
+
+static TM1638_Handler_t Handler;
+static Mock_Chip_t Chip;
+static uint32_t Seed = 1638;
+
+
+static uint32_t
+Random(void)
+{
+  Seed ^= Seed << 13;
+  Seed ^= Seed >> 17;
+  Seed ^= Seed << 5;
+  return Seed;
+}
+
+// Common-anode conversion of the original driver, one register bit at a time
+static void
+Reference(uint8_t *Register, const uint8_t *DigitData,
+          uint8_t StartAddr, uint8_t Count)
+{
+  uint8_t Shift = 0;
+  uint8_t DigitDataBuff = 0;
+  uint8_t i = 0, j = 0;
+
+  for (j = 0; j < Count; j++)
+  {
+    DigitDataBuff = DigitData[j];
+
+    if ((j + StartAddr) <= 7)
+    {
+      Shift = j + StartAddr;
+      i = 0;
+    }
+    else if ((j + StartAddr) == 8 || (j + StartAddr) == 9)
+    {
+      Shift = (j + StartAddr) - 8;
+      i = 1;
+    }
+    else
+    {
+      i = 16;
+    }
+
+    for (; i < 16; i += 2, DigitDataBuff >>= 1)
+    {
+      if (DigitDataBuff & 0x01)
+        Register[i] |= (1 << Shift);
+      else
+        Register[i] &= ~(1 << Shift);
+    }
+  }
+}
+
+
+int main(void)
+{
+  uint8_t Expected[16], Digits[10];
+  uint32_t n, Mismatch = 0;
+  uint8_t i;
+  clock_t Start;
+  double TransposeNs, ReferenceNs;
+
+  Mock_Init(&Chip, &Handler);
+  Mock_UseTransfer(&Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComAnode);
+  TM1638_SetAutoFlush(&Handler, 0);
+
+  for (n = 0; n < CASES; n++)
+  {
+    uint8_t StartAddr = Random() % 10;
+    uint8_t Count = 1 + Random() % (10 - StartAddr);
+
+    for (i = 0; i < 16; i++)
+      Handler.DisplayRegister[i] = Expected[i] = (uint8_t)Random();
+    for (i = 0; i < Count; i++)
+      Digits[i] = (uint8_t)Random();
+
+    Reference(Expected, Digits, StartAddr, Count);
+    TEST_CHECK(TM1638_SetMultipleDigit(&Handler, Digits, StartAddr, Count) ==
+               TM1638_OK);
+    if (memcmp(Expected, Handler.DisplayRegister, 16) != 0 && Mismatch++ < 5)
+      printf("mismatch: start %u count %u\n", StartAddr, Count);
+  }
+  TEST_CHECK(Mismatch == 0);
+
+  // Digits beyond 9 are rejected and the image is kept
+  memcpy(Expected, Handler.DisplayRegister, 16);
+  TEST_CHECK(TM1638_SetMultipleDigit(&Handler, Digits, 8, 3) == TM1638_FAIL);
+  TEST_CHECK(TM1638_SetMultipleDigit(&Handler, Digits, 10, 1) == TM1638_FAIL);
+  TEST_CHECK(memcmp(Expected, Handler.DisplayRegister, 16) == 0);
+
+  // Microbenchmark, all 10 digits (image only, auto flush is off)
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    Digits[n & 7] = (uint8_t)n;
+    TM1638_SetMultipleDigit(&Handler, Digits, 0, 10);
+  }
+  TransposeNs = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    Digits[n & 7] = (uint8_t)n;
+    Reference(Expected, Digits, 0, 10);
+  }
+  ReferenceNs = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+
+  printf("%d random cases, 10 digits: library call %.1f ns, bit loop %.1f ns "
+         "(checksum %02X)\n", CASES, TransposeNs, ReferenceNs,
+         Expected[0] ^ Handler.DisplayRegister[0]);
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,285 @@
+/**
+ **********************************************************************************
+ * @file   test_async.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Asynchronous jobs must send the frames of the blocking functions
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+static TM1638_Handler_t SyncHandler, AsyncHandler;
+static Mock_Chip_t SyncChip, AsyncChip;
+static uint32_t Seed = 1638;
+static uint8_t TimerRunning;
+static uint8_t DoneJob = 0xFF;
+
+
+static uint8_t
+Random(void)
+{
+  Seed ^= Seed << 13;
+  Seed ^= Seed >> 17;
+  Seed ^= Seed << 5;
+  return (uint8_t)Seed;
+}
+
+static void
+TimerStart(void *Context)
+{
+  (void)Context;
+  TimerRunning = 1;
+}
+
+static void
+TimerStop(void *Context)
+{
+  (void)Context;
+  TimerRunning = 0;
+}
+
+static void
+AsyncDone(TM1638_Handler_t *Handler, uint8_t Job)
+{
+  (void)Handler;
+  DoneJob = Job;
+}
+
+// Change the same random registers of both handlers
+static void
+Change(uint8_t Registers)
+{
+  uint8_t i, Reg, Data;
+
+  for (i = 0; i < Registers; i++)
+  {
+    Reg = Random() & 0x0F;
+    Data = Random();
+    TM1638_SetMultipleDigit(&SyncHandler, &Data, Reg, 1);
+    TM1638_SetMultipleDigit(&AsyncHandler, &Data, Reg, 1);
+  }
+}
+
+// Run the job by polling, no call may clock more than BITS_PER_POLL bits
+static uint32_t
+PollAll(void)
+{
+  uint32_t Polls = 0;
+  uint32_t Edges;
+
+  do
+  {
+    Edges = AsyncChip.Count.ClkEdges;
+    Polls++;
+    if (TM1638_Poll(&AsyncHandler) == TM1638_OK)
+      break;
+    TEST_CHECK(AsyncChip.Count.ClkEdges - Edges <=
+               TM1638_CONFIG_ASYNC_BITS_PER_POLL);
+  } while (Polls < 10000);
+
+  TEST_CHECK(AsyncHandler.Async.Busy == 0);
+  return Polls;
+}
+
+static void
+CompareFlush(uint8_t Registers)
+{
+  uint32_t Polls;
+
+  Change(Registers);
+  Mock_Clear(&SyncChip);
+  Mock_Clear(&AsyncChip);
+
+  TEST_CHECK(TM1638_Flush(&SyncHandler) == TM1638_OK);
+  TEST_CHECK(TM1638_FlushAsync(&AsyncHandler) == TM1638_OK);
+  Polls = PollAll();
+
+  TEST_CHECK(SyncChip.Errors == 0 && AsyncChip.Errors == 0);
+  TEST_CHECK(Mock_SameFrames(&SyncChip, &AsyncChip));
+  TEST_CHECK(memcmp(SyncChip.Ram, AsyncChip.Ram, 16) == 0);
+  TEST_CHECK(memcmp(AsyncChip.Ram, AsyncHandler.DisplayRegister, 16) == 0);
+  TEST_CHECK(DoneJob == TM1638AsyncJobFlush);
+  TEST_CHECK(Polls > 1);
+}
+
+static void
+CompareScan(void)
+{
+  uint32_t SyncKeys = 0, AsyncKeys = 0;
+  uint8_t i;
+
+  for (i = 0; i < 4; i++)
+    SyncChip.Keys[i] = AsyncChip.Keys[i] = Random() & 0x77;
+  Mock_Clear(&SyncChip);
+  Mock_Clear(&AsyncChip);
+
+  TEST_CHECK(TM1638_ScanKeys(&SyncHandler, &SyncKeys) == TM1638_OK);
+  TEST_CHECK(TM1638_ScanKeysAsync(&AsyncHandler) == TM1638_OK);
+  PollAll();
+  TEST_CHECK(TM1638_GetAsyncKeys(&AsyncHandler, &AsyncKeys) == TM1638_OK);
+
+  TEST_CHECK(SyncChip.Errors == 0 && AsyncChip.Errors == 0);
+  TEST_CHECK(Mock_SameFrames(&SyncChip, &AsyncChip));
+  TEST_CHECK(SyncKeys == AsyncKeys);
+  TEST_CHECK(DoneJob == TM1638AsyncJobScan);
+}
+
+static void
+CompareAll(void)
+{
+  uint8_t Round;
+
+  for (Round = 0; Round < 50; Round++)
+  {
+    CompareFlush(1 + (Round % 16));
+    CompareScan();
+  }
+}
+
+// Every bus function must return BUSY without touching the bus
+static void
+CheckBusy(void)
+{
+  const TM1638_Timing_t Timing = {500, 500, 2000, 1000};
+  const uint8_t Data[4] = {0x3F, 0x06, 0x5B, 0x4F};
+  TM1638_Transaction_t Transaction;
+  TM1638_Virtual_t Virtual;
+  TM1638_Fade_t Fade;
+  TM1638_Group_t Group;
+  uint8_t KeyRegs[4];
+  uint32_t Keys;
+  uint32_t Frames;
+
+  TM1638_VirtualInit(&Virtual, &AsyncHandler, 1, 8, 1);
+  TM1638_GroupInit(&Group, &AsyncHandler, 1);
+  TM1638_FadeStart(&Fade, &AsyncHandler, 8, 4, NULL, 0, 0);
+  TM1638_TransactionBegin(&AsyncHandler, &Transaction);
+  TM1638_TransactionWrite(&Transaction, Data, 0, 4);
+
+  Change(16);
+  TEST_CHECK(TM1638_FlushAsync(&AsyncHandler) == TM1638_OK);
+  TEST_CHECK(TM1638_Poll(&AsyncHandler) == TM1638_BUSY);
+  Frames = AsyncChip.Count.Frames;
+
+  TEST_CHECK(TM1638_Flush(&AsyncHandler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_DeInit(&AsyncHandler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_SetTiming(&AsyncHandler, &Timing) == TM1638_BUSY);
+  TEST_CHECK(AsyncHandler.Delay.ClkLow == 1);
+  TEST_CHECK(TM1638_ConfigDisplay(&AsyncHandler, 2, TM1638DisplayStateON) ==
+             TM1638_BUSY);
+  TEST_CHECK(TM1638_ScanKeys(&AsyncHandler, &Keys) == TM1638_BUSY);
+  TEST_CHECK(TM1638_ScanKeysRaw(&AsyncHandler, KeyRegs) == TM1638_BUSY);
+  TEST_CHECK(TM1638_TransactionCommit(&Transaction) == TM1638_BUSY);
+  TEST_CHECK(TM1638_VirtualFlush(&Virtual) == TM1638_BUSY);
+  TEST_CHECK(TM1638_FadeTick(&Fade) == TM1638_BUSY);
+  TEST_CHECK(TM1638_GroupFlush(&Group) == TM1638_BUSY);
+  TEST_CHECK(TM1638_GroupConfigDisplay(&Group, 2, TM1638DisplayStateON) ==
+             TM1638_BUSY);
+  TEST_CHECK(TM1638_GroupWriteAll(&Group, Data, 0, 4) == TM1638_BUSY);
+  TEST_CHECK(TM1638_FlushAsync(&AsyncHandler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_ScanKeysAsync(&AsyncHandler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_GetAsyncKeys(&AsyncHandler, &Keys) == TM1638_BUSY);
+
+  // Digit functions only update the image, the next flush sends it
+  TEST_CHECK(TM1638_SetMultipleDigit(&AsyncHandler, Data, 4, 4) == TM1638_OK);
+  TEST_CHECK(memcmp(&AsyncHandler.DisplayRegister[4], Data, 4) == 0);
+
+  TEST_CHECK(AsyncChip.Count.Frames == Frames);
+  TEST_CHECK(AsyncChip.Control != 0x8A);
+
+  PollAll();
+  TEST_CHECK(TM1638_Flush(&AsyncHandler) == TM1638_OK);
+  TEST_CHECK(memcmp(AsyncChip.Ram, AsyncHandler.DisplayRegister, 16) == 0);
+  TEST_CHECK(AsyncChip.Errors == 0);
+}
+
+// Job clocked by TM1638_TimerTick(), TM1638_Poll() only reports its state
+static void
+CheckTimer(void)
+{
+  uint32_t Ticks = 0;
+
+  AsyncHandler.TimerStart = TimerStart;
+  AsyncHandler.TimerStop = TimerStop;
+
+  Change(16);
+  Mock_Clear(&AsyncChip);
+  TEST_CHECK(TM1638_FlushAsync(&AsyncHandler) == TM1638_OK);
+  TEST_CHECK(TimerRunning == 1);
+  TEST_CHECK(TM1638_Poll(&AsyncHandler) == TM1638_BUSY);
+  TEST_CHECK(AsyncChip.Count.ClkEdges == 0);
+
+  while (AsyncHandler.Async.Busy && Ticks < 100000)
+  {
+    TM1638_TimerTick(&AsyncHandler);
+    Ticks++;
+  }
+
+  TEST_CHECK(TimerRunning == 0);
+  TEST_CHECK(TM1638_Poll(&AsyncHandler) == TM1638_OK);
+  TEST_CHECK(memcmp(AsyncChip.Ram, AsyncHandler.DisplayRegister, 16) == 0);
+  TEST_CHECK(AsyncChip.Errors == 0);
+
+  AsyncHandler.TimerStart = NULL;
+  AsyncHandler.TimerStop = NULL;
+}
+
+
+static void
+Setup(uint8_t UseTransfer)
+{
+  Mock_Init(&SyncChip, &SyncHandler);
+  Mock_Init(&AsyncChip, &AsyncHandler);
+  if (UseTransfer)
+  {
+    Mock_UseTransfer(&SyncHandler);
+    Mock_UseTransfer(&AsyncHandler);
+  }
+  TM1638_Init(&SyncHandler, TM1638DisplayTypeComCathode);
+  TM1638_Init(&AsyncHandler, TM1638DisplayTypeComCathode);
+  TM1638_SetAutoFlush(&SyncHandler, 0);
+  TM1638_SetAutoFlush(&AsyncHandler, 0);
+  AsyncHandler.AsyncDone = AsyncDone;
+}
+
+
+int main(void)
+{
+  // Bit-banged jobs
+  Setup(0);
+  CompareAll();
+  CheckBusy();
+  CheckTimer();
+
+  // Jobs sent through Transfer callback, one frame per poll
+  Setup(1);
+  CompareAll();
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/**
+ **********************************************************************************
+ * @file   test_byte_io.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Byte callbacks must send the bit-banged frames with the same timing
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+static TM1638_Handler_t BitHandler, ByteHandler;
+static Mock_Chip_t BitChip, ByteChip;
+
+
+static uint32_t
+Callbacks(const Mock_Chip_t *Chip)
+{
+  const Mock_Counters_t *Count = &Chip->Count;
+
+  return Count->DioConfig + Count->DioWrite + Count->DioRead +
+         Count->ClkWrite + Count->StbWrite + Count->Delay +
+         Count->WriteByte + Count->ReadByte;
+}
+
+static void
+FullFlush(TM1638_Handler_t *Handler, Mock_Chip_t *Chip, uint8_t Seed)
+{
+  uint8_t i;
+
+  for (i = 0; i < 16; i++)
+    Handler->DisplayRegister[i] = (uint8_t)(Seed + i * 37);
+  Handler->DirtyMask = 0xFFFF;
+  Mock_Clear(Chip);
+  TM1638_Flush(Handler);
+}
+
+
+int main(void)
+{
+  const TM1638_Timing_t Fast = {0, 0, 0, 0};
+  const uint8_t KeyRegs[4] = {0x01, 0x20, 0x04, 0x80};
+  uint32_t BitKeys = 0, ByteKeys = 0;
+
+  Mock_Init(&BitChip, &BitHandler);
+  Mock_Init(&ByteChip, &ByteHandler);
+  Mock_UseByteIO(&ByteHandler);
+  memcpy(BitChip.Keys, KeyRegs, 4);
+  memcpy(ByteChip.Keys, KeyRegs, 4);
+
+  TM1638_Init(&BitHandler, TM1638DisplayTypeComCathode);
+  TM1638_Init(&ByteHandler, TM1638DisplayTypeComCathode);
+
+  // 16-byte flush with the default profile
+  FullFlush(&BitHandler, &BitChip, 3);
+  FullFlush(&ByteHandler, &ByteChip, 3);
+  TEST_CHECK(BitChip.Errors == 0 && ByteChip.Errors == 0);
+  TEST_CHECK(Mock_SameFrames(&BitChip, &ByteChip));
+  TEST_CHECK(memcmp(BitChip.Ram, ByteChip.Ram, 16) == 0);
+  TEST_CHECK(ByteChip.Count.WriteByte == 18);
+  TEST_CHECK(ByteChip.Count.ClkWrite == 0 && ByteChip.Count.DioWrite == 0);
+  // Byte callbacks keep the bit timing of the profile
+  TEST_CHECK(BitChip.Count.DelayTotal == ByteChip.Count.DelayTotal);
+  printf("16-byte flush, default timing: %lu callbacks bit-banged, "
+         "%lu with byte callbacks\n",
+         (unsigned long)Callbacks(&BitChip), (unsigned long)Callbacks(&ByteChip));
+
+  // The same with zero delays, bit path has no delay calls left either
+  TM1638_SetTiming(&BitHandler, &Fast);
+  TM1638_SetTiming(&ByteHandler, &Fast);
+  FullFlush(&BitHandler, &BitChip, 5);
+  FullFlush(&ByteHandler, &ByteChip, 5);
+  TEST_CHECK(Mock_SameFrames(&BitChip, &ByteChip));
+  TEST_CHECK(BitChip.Count.Delay == 0 && ByteChip.Count.Delay == 0);
+  printf("16-byte flush, zero timing: %lu callbacks bit-banged, "
+         "%lu with byte callbacks\n",
+         (unsigned long)Callbacks(&BitChip), (unsigned long)Callbacks(&ByteChip));
+
+  // Key scan reads through ReadByte after ReadWait
+  TM1638_Init(&BitHandler, TM1638DisplayTypeComCathode);
+  TM1638_Init(&ByteHandler, TM1638DisplayTypeComCathode);
+  Mock_Clear(&BitChip);
+  Mock_Clear(&ByteChip);
+  TM1638_ScanKeys(&BitHandler, &BitKeys);
+  TM1638_ScanKeys(&ByteHandler, &ByteKeys);
+  TEST_CHECK(BitChip.Errors == 0 && ByteChip.Errors == 0);
+  TEST_CHECK(Mock_SameFrames(&BitChip, &ByteChip));
+  TEST_CHECK(BitKeys == ByteKeys && BitKeys != 0);
+  TEST_CHECK(ByteChip.Count.ReadByte == 4);
+  TEST_CHECK(BitChip.Count.DelayTotal == ByteChip.Count.DelayTotal);
+
+  if (Test_Failures)
+  {
+    Mock_PrintFrames(&BitChip);
+    Mock_PrintFrames(&ByteChip);
+  }
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,181 @@
+/**
+ **********************************************************************************
+ * @file   test_dimming.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Per-digit dimming must show each digit in Level of every cycle
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+#define STEPS   TM1638_CONFIG_DIM_STEPS
+#define CYCLES  10
+
+
+static TM1638_Handler_t Handler;
+static Mock_Chip_t Chip;
+
+
+// Segments of a common-anode digit as shown by the chip
+static uint8_t
+AnodeDigit(uint8_t Digit)
+{
+  uint8_t Segments = 0;
+  uint8_t b;
+
+  for (b = 0; b < 8; b++)
+    if (Chip.Ram[2 * b + Digit / 8] & (1 << (Digit % 8)))
+      Segments |= 1 << b;
+
+  return Segments;
+}
+
+static uint8_t
+Shown(uint8_t Type, uint8_t Digit)
+{
+  return (Type == TM1638DisplayTypeComCathode) ? Chip.Ram[Digit]
+                                               : AnodeDigit(Digit);
+}
+
+static void
+TestDutyCycle(uint8_t Type)
+{
+  const uint8_t Segments[10] =
+    {0xFF, 0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F};
+  uint8_t On[10] = {0};
+  uint8_t Gap[10] = {0}, MaxGap[10] = {0};
+  uint8_t Digits = (Type == TM1638DisplayTypeComCathode) ? 8 : 10;
+  uint8_t d, Tick;
+
+  Mock_Init(&Chip, &Handler);
+  TM1638_Init(&Handler, Type);
+  TM1638_SetMultipleDigit(&Handler, Segments, 0, Digits);
+
+  // Digit d gets level d % (STEPS + 1)
+  for (d = 0; d < Digits; d++)
+    TEST_CHECK(TM1638_SetDigitLevel(&Handler, d, d % (STEPS + 1)) == TM1638_OK);
+
+  for (Tick = 0; Tick < STEPS * CYCLES; Tick++)
+  {
+    TEST_CHECK(TM1638_DimTick(&Handler) == TM1638_OK);
+
+    for (d = 0; d < Digits; d++)
+    {
+      uint8_t Digit = Shown(Type, d);
+
+      // A digit is either fully shown or blank
+      TEST_CHECK(Digit == Segments[d] || Digit == 0);
+      if (Digit)
+      {
+        On[d]++;
+        Gap[d] = 0;
+      }
+      else if (++Gap[d] > MaxGap[d])
+      {
+        MaxGap[d] = Gap[d];
+      }
+    }
+  }
+
+  for (d = 0; d < Digits; d++)
+  {
+    uint8_t Level = d % (STEPS + 1);
+
+    TEST_CHECK(On[d] == Level * CYCLES);
+    // On-steps are spread over the cycle
+    if (Level)
+      TEST_CHECK(MaxGap[d] <= (STEPS + Level - 1) / Level - 1);
+  }
+  TEST_CHECK(Chip.Errors == 0);
+}
+
+static void
+TestChangedOnly(void)
+{
+  const uint8_t Segments[4] = {0x3F, 0x06, 0x5B, 0x4F};
+  uint8_t Tick;
+
+  Mock_Init(&Chip, &Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+  TM1638_SetMultipleDigit(&Handler, Segments, 0, 4);
+
+  // All digits at full level, nothing changes between steps
+  Mock_Clear(&Chip);
+  for (Tick = 0; Tick < STEPS * 2; Tick++)
+    TM1638_DimTick(&Handler);
+  TEST_CHECK(Chip.Count.Frames == 0);
+
+  // One digit at half level, only its register is sent at each step
+  TM1638_SetDigitLevel(&Handler, 2, STEPS / 2);
+  for (Tick = 0; Tick < STEPS; Tick++)
+    TM1638_DimTick(&Handler);
+  Mock_Clear(&Chip);
+  for (Tick = 0; Tick < STEPS; Tick++)
+    TM1638_DimTick(&Handler);
+  TEST_CHECK(Chip.Count.Frames == 2 * STEPS);
+  TEST_CHECK(Chip.Frames[1].Length == 2 && Chip.Frames[1].Data[0] == 0xC2);
+
+  TEST_CHECK(TM1638_SetDigitLevel(&Handler, 16, 1) == TM1638_FAIL);
+  TEST_CHECK(TM1638_SetDigitLevel(&Handler, 0, STEPS + 1) == TM1638_FAIL);
+}
+
+static void
+TestBusy(void)
+{
+  const uint8_t Segments[2] = {0x3F, 0x06};
+  uint8_t Step;
+
+  Mock_Init(&Chip, &Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+  TM1638_SetAutoFlush(&Handler, 0);
+  TM1638_SetMultipleDigit(&Handler, Segments, 0, 2);
+  TM1638_SetDigitLevel(&Handler, 0, 1);
+
+  TEST_CHECK(TM1638_FlushAsync(&Handler) == TM1638_OK);
+  Step = Handler.DimStep;
+  TEST_CHECK(TM1638_DimTick(&Handler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_DimTick(&Handler) == TM1638_BUSY);
+  TEST_CHECK(Handler.DimStep == Step);
+
+  while (TM1638_Poll(&Handler) == TM1638_BUSY);
+  TEST_CHECK(TM1638_DimTick(&Handler) == TM1638_OK);
+  TEST_CHECK(Handler.DimStep == (Step + 1) % STEPS);
+  TEST_CHECK(Chip.Ram[0] == (Handler.DimMask[Handler.DimStep][0] & 0x3F));
+}
+
+
+int main(void)
+{
+  TestDutyCycle(TM1638DisplayTypeComCathode);
+  TestDutyCycle(TM1638DisplayTypeComAnode);
+  TestChangedOnly();
+  TestBusy();
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,153 @@
+/**
+ **********************************************************************************
+ * @file   test_keys.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Key decoding against the bit loops of the original driver
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include <time.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+#define BENCH_RUNS  1000000
+
+
+static TM1638_Handler_t Handler;
+static Mock_Chip_t Chip;
+
+
+// Nanoseconds per run since Start
+static double
+Elapsed(clock_t Start)
+{
+  return (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+}
+
+
+// Key decoding of the original driver, one bit at a time
+static uint32_t
+Reference(const uint8_t *KeyRegs)
+{
+  uint32_t KeysBuff = 0;
+  uint8_t Kn = 0x01;
+
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    for (int8_t j = 3; j >= 0; j--)
+    {
+      KeysBuff <<= 1;
+
+      if (KeyRegs[j] & (Kn << 4))
+        KeysBuff |= 1;
+
+      KeysBuff <<= 1;
+
+      if (KeyRegs[j] & Kn)
+        KeysBuff |= 1;
+    }
+
+    Kn <<= 1;
+  }
+
+  return KeysBuff;
+}
+
+
+int main(void)
+{
+  uint32_t Value, Keys, Mismatch = 0;
+  uint32_t n, Sum = 0;
+  uint8_t KeyRegs[4];
+  clock_t Start;
+  double Raw, Gather, Loops;
+
+  Mock_Init(&Chip, &Handler);
+  Mock_UseTransfer(&Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+
+  // All 2^24 states of the key bits (0-2 and 4-6 of each register), the
+  // unused bits 3 and 7 are set in turn
+  for (Value = 0; Value < (1UL << 24); Value++)
+  {
+    uint32_t Unused = (Value & 0x0F) * 0x11111111U & 0x88888888U;
+
+    for (n = 0; n < 4; n++)
+    {
+      uint8_t Bits = (uint8_t)(Value >> (6 * n));
+
+      Chip.Keys[n] = (uint8_t)((Bits & 0x07) | ((Bits & 0x38) << 1) |
+                               (Unused >> (8 * n)));
+    }
+
+    TM1638_ScanKeys(&Handler, &Keys);
+    if (Keys != Reference(Chip.Keys) && Mismatch++ < 5)
+      printf("mismatch: %02X %02X %02X %02X\n", Chip.Keys[0], Chip.Keys[1],
+             Chip.Keys[2], Chip.Keys[3]);
+  }
+  TEST_CHECK(Mismatch == 0);
+  TEST_CHECK(Chip.Errors == 0);
+
+  // The frame is the same in all runs, the raw scan alone is the transport
+  // time that is taken off the other two
+  memset(Chip.Keys, 0, 4);
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    Chip.Keys[n & 3] = (uint8_t)n;
+    TM1638_ScanKeysRaw(&Handler, KeyRegs);
+    Sum += KeyRegs[n & 3];
+  }
+  Raw = Elapsed(Start);
+
+  memset(Chip.Keys, 0, 4);
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    Chip.Keys[n & 3] = (uint8_t)n;
+    TM1638_ScanKeys(&Handler, &Keys);
+    Sum += Keys;
+  }
+  Gather = Elapsed(Start) - Raw;
+
+  memset(Chip.Keys, 0, 4);
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    Chip.Keys[n & 3] = (uint8_t)n;
+    TM1638_ScanKeysRaw(&Handler, KeyRegs);
+    Sum -= Reference(KeyRegs);
+  }
+  Loops = Elapsed(Start) - Raw;
+
+  printf("key decoding over raw scan (%.1f ns): bit gathering %.1f ns, "
+         "bit loops %.1f ns (checksum %08lX)\n", Raw, Gather, Loops,
+         (unsigned long)Sum);
+
+  return TEST_RESULT();
+}
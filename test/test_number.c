@@ -0,0 +1,271 @@
+/**
+ **********************************************************************************
+ * @file   test_number.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Division-free number output against snprintf and a /10 loop
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+#define CASES       100000
+#define BENCH_RUNS  1000000
+
+
+static TM1638_Handler_t Handler;
+static Mock_Chip_t Chip;
+static uint32_t Seed = 1638;
+static uint32_t Mismatch;
+
+
+static uint32_t
+Random(void)
+{
+  Seed ^= Seed << 13;
+  Seed ^= Seed >> 17;
+  Seed ^= Seed << 5;
+  return Seed;
+}
+
+// Values of every length, with the ones around 16-bit and 32-bit limits
+static uint32_t
+RandomValue(void)
+{
+  static const uint32_t Edges[] =
+  {
+    0, 1, 9, 10, 99, 100, 9999, 10000, 65535, 65536, 99999, 100000,
+    999999999, 1000000000, 2147483647, 2147483648U, 4294967295U
+  };
+  uint32_t Select = Random() % 8;
+
+  if (Select == 0)
+    return Edges[Random() % (sizeof(Edges) / sizeof(Edges[0]))];
+
+  return Random() >> (Random() % 32);
+}
+
+// Expected registers: text right-aligned in Count digits, '.' sets bit 7
+static void
+Expect(uint8_t *Register, const char *Text, uint8_t Count, uint8_t Fail)
+{
+  uint8_t i;
+
+  for (i = 0; i < Count; i++)
+  {
+    uint8_t c = Fail ? '-' : (uint8_t)Text[i];
+
+    Register[i] = Handler.Font[c];
+  }
+}
+
+static void
+Check(const char *Name, uint32_t Value, TM1638_Result_t Result,
+      const uint8_t *Expected, uint8_t StartAddr, uint8_t Count, uint8_t Fail)
+{
+  if (Result != (Fail ? TM1638_FAIL : TM1638_OK) ||
+      memcmp(&Handler.DisplayRegister[StartAddr], Expected, Count) != 0)
+  {
+    if (Mismatch++ < 10)
+      printf("%s: %lu in %u digits\n", Name, (unsigned long)Value, Count);
+  }
+}
+
+static void
+TestInteger(void)
+{
+  uint8_t Expected[16];
+  char Text[24];
+  uint32_t n;
+
+  for (n = 0; n < CASES; n++)
+  {
+    uint8_t Count = 1 + Random() % 12;
+    uint8_t StartAddr = Random() % (17 - Count);
+    uint8_t Flags = Random() & TM1638NumberZeroPad;
+    uint32_t Value = RandomValue();
+    int32_t Signed = (int32_t)Value;
+    uint8_t Fail;
+    TM1638_Result_t Result;
+
+    // Signed decimal
+    snprintf(Text, sizeof(Text), Flags ? "%0*ld" : "%*ld", Count, (long)Signed);
+    Fail = strlen(Text) > Count;
+    Expect(Expected, Text, Count, Fail);
+    Result = TM1638_SetNumber(&Handler, Signed, StartAddr, Count, Flags);
+    Check("SetNumber", Value, Result, Expected, StartAddr, Count, Fail);
+
+    // Unsigned decimal
+    snprintf(Text, sizeof(Text), Flags ? "%0*lu" : "%*lu", Count,
+             (unsigned long)Value);
+    Fail = strlen(Text) > Count;
+    Expect(Expected, Text, Count, Fail);
+    Result = TM1638_SetNumberUnsigned(&Handler, Value, StartAddr, Count, Flags);
+    Check("SetNumberUnsigned", Value, Result, Expected, StartAddr, Count, Fail);
+
+    // Hexadecimal
+    snprintf(Text, sizeof(Text), Flags ? "%0*lX" : "%*lX", Count,
+             (unsigned long)Value);
+    Fail = strlen(Text) > Count;
+    Expect(Expected, Text, Count, Fail);
+    Result = TM1638_SetNumber_HEX(&Handler, Value, StartAddr, Count, Flags);
+    Check("SetNumber_HEX", Value, Result, Expected, StartAddr, Count, Fail);
+  }
+}
+
+static void
+TestFixed(void)
+{
+  uint8_t Expected[16];
+  char Digits[24], Text[24];
+  uint32_t n;
+
+  for (n = 0; n < CASES; n++)
+  {
+    uint8_t Count = 2 + Random() % 11;
+    uint8_t StartAddr = Random() % (17 - Count);
+    uint8_t Flags = Random() & TM1638NumberZeroPad;
+    uint8_t DecimalPos = Random() % Count;
+    int32_t Number = (int32_t)RandomValue();
+    uint8_t Negative = Number < 0;
+    unsigned long Abs = Negative ? 0UL - (unsigned long)(uint32_t)Number
+                                 : (unsigned long)Number;
+    unsigned long Scale = 1;
+    uint8_t i, Length, Fail;
+    TM1638_Result_t Result;
+
+    for (i = 0; i < DecimalPos; i++)
+      Scale *= 10;
+    Abs &= 0xFFFFFFFFUL;
+
+    // Integer part (at least one digit) and DecimalPos fraction digits
+    if (DecimalPos)
+      snprintf(Digits, sizeof(Digits), "%lu%0*lu", Abs / Scale, DecimalPos,
+               Abs % Scale);
+    else
+      snprintf(Digits, sizeof(Digits), "%lu", Abs);
+
+    Length = (uint8_t)strlen(Digits);
+    Fail = Length + Negative > Count;
+    if (!Fail)
+    {
+      if (Flags)
+        snprintf(Text, sizeof(Text), "%s%*s", Negative ? "-" : "",
+                 Count - Negative, Digits);
+      else
+        snprintf(Text, sizeof(Text), "%*s%s%s", Count - Negative - Length, "",
+                 Negative ? "-" : "", Digits);
+      // Zero padding of a string, pad with blanks and turn them into zeros
+      for (i = 0; Text[i]; i++)
+        if (Flags && Text[i] == ' ')
+          Text[i] = '0';
+    }
+
+    Expect(Expected, Text, Count, Fail);
+    if (!Fail && DecimalPos)
+      Expected[Count - 1 - DecimalPos] |= TM1638DecimalPoint;
+
+    Result = TM1638_SetNumberFixed(&Handler, Number, DecimalPos, StartAddr,
+                                   Count, Flags);
+    Check("SetNumberFixed", (uint32_t)Number, Result, Expected, StartAddr,
+          Count, Fail);
+  }
+}
+
+// Conversion of the original approach, one division per digit
+static void
+NaiveNumber(uint32_t Number, uint8_t Count)
+{
+  char Text[16];
+  uint8_t i = Count;
+
+  do
+  {
+    Text[--i] = '0' + Number % 10;
+    Number /= 10;
+  } while (Number && i);
+  while (i)
+    Text[--i] = ' ';
+
+  TM1638_SetMultipleDigit_CHAR(&Handler, (const uint8_t *)Text, 0, Count);
+}
+
+static void
+Benchmark(void)
+{
+  char Text[16];
+  uint32_t n;
+  clock_t Start;
+  double Library, Naive, Printf;
+
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+    TM1638_SetNumberUnsigned(&Handler, n * 2654435761U >> (n & 31), 0, 10, 0);
+  Library = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+    NaiveNumber(n * 2654435761U >> (n & 31), 10);
+  Naive = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+
+  Start = clock();
+  for (n = 0; n < BENCH_RUNS; n++)
+  {
+    snprintf(Text, sizeof(Text), "%10lu",
+             (unsigned long)(n * 2654435761U >> (n & 31)));
+    TM1638_SetMultipleDigit_CHAR(&Handler, (const uint8_t *)Text, 0, 10);
+  }
+  Printf = (double)(clock() - Start) * 1e9 / CLOCKS_PER_SEC / BENCH_RUNS;
+
+  printf("10-digit unsigned: library %.1f ns, /10 loop %.1f ns, "
+         "snprintf %.1f ns\n", Library, Naive, Printf);
+}
+
+
+int main(void)
+{
+  Mock_Init(&Chip, &Handler);
+  Mock_UseTransfer(&Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+  TM1638_SetAutoFlush(&Handler, 0);
+
+  TestInteger();
+  TestFixed();
+  TEST_CHECK(Mismatch == 0);
+
+  // Out of range positions
+  TEST_CHECK(TM1638_SetNumber(&Handler, 1, 10, 7, 0) == TM1638_FAIL);
+  TEST_CHECK(TM1638_SetNumber(&Handler, 1, 0, 0, 0) == TM1638_FAIL);
+  TEST_CHECK(TM1638_SetNumberFixed(&Handler, 1, 4, 0, 4, 0) == TM1638_FAIL);
+
+  Benchmark();
+
+  return TEST_RESULT();
+}
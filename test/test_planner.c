@@ -0,0 +1,173 @@
+/**
+ **********************************************************************************
+ * @file   test_planner.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Frame planner against always-burst flushes and the optimal plan
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+#define OVERHEAD  TM1638_CONFIG_FRAME_OVERHEAD_BITS
+
+
+typedef struct Cost_s
+{
+  uint32_t Edges;
+  uint32_t StbToggles;
+} Cost_t;
+
+
+static TM1638_Handler_t Handler;
+static Mock_Chip_t Chip;
+
+
+static uint32_t
+FrameCost(const Mock_Chip_t *Chip)
+{
+  uint32_t Cost = 0;
+  uint8_t i;
+
+  for (i = 0; i < Chip->NumFrames; i++)
+    Cost += 8U * Chip->Frames[i].Length + OVERHEAD;
+
+  return Cost;
+}
+
+// Fewest bits plus frame overheads to send all registers of Mask
+static uint32_t
+OptimalCost(uint16_t Mask)
+{
+  uint32_t Best[17];
+  uint8_t a, b;
+
+  Best[0] = 0;
+  for (b = 1; b <= 16; b++)
+  {
+    Best[b] = (Mask & (1U << (b - 1))) ? UINT32_MAX : Best[b - 1];
+    if (!(Mask & (1U << (b - 1))))
+      continue;
+
+    // Last frame sends registers a to b-1
+    for (a = 0; a < b; a++)
+    {
+      uint32_t Cost;
+
+      if (!(Mask & (1U << a)) || Best[a] == UINT32_MAX)
+        continue;
+      Cost = Best[a] + 8U * (1 + b - a) + OVERHEAD;
+      if (Cost < Best[b])
+        Best[b] = Cost;
+    }
+  }
+
+  // Data command frame
+  return Best[16] + 8 + OVERHEAD;
+}
+
+static uint16_t
+Span(uint16_t Mask)
+{
+  uint8_t First = 0, Last = 15;
+
+  while (!(Mask & (1U << First)))
+    First++;
+  while (!(Mask & (1U << Last)))
+    Last--;
+
+  return (uint16_t)(((1U << (Last - First + 1)) - 1) << First);
+}
+
+// Flush Mask after changing its registers, return the cost and check the chip
+static uint32_t
+Flush(uint16_t Dirty, uint16_t Mask, Cost_t *Total)
+{
+  uint8_t i;
+
+  for (i = 0; i < 16; i++)
+    if (Dirty & (1U << i))
+      Handler.DisplayRegister[i] = (uint8_t)rand();
+  Handler.DirtyMask = Mask;
+
+  Mock_Clear(&Chip);
+  TM1638_Flush(&Handler);
+  TEST_CHECK(memcmp(Chip.Ram, Handler.DisplayRegister, 16) == 0);
+  TEST_CHECK(Chip.Errors == 0);
+
+  for (i = 0; i < Chip.NumFrames; i++)
+    Total->Edges += 8U * Chip.Frames[i].Length;
+  Total->StbToggles += 2U * Chip.NumFrames;
+
+  return FrameCost(&Chip);
+}
+
+
+int main(void)
+{
+  Cost_t Planned = {0}, SpanBurst = {0}, FullBurst = {0};
+  uint32_t Mask;
+  uint32_t Cases = 0;
+
+  Mock_Init(&Chip, &Handler);
+  Mock_UseTransfer(&Handler);
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+  srand(1638);
+
+  // Every dirty mask, each strategy sends the same new register values
+  for (Mask = 1; Mask <= 0xFFFF; Mask++)
+  {
+    uint32_t Cost, SpanCost, FullCost;
+
+    Cost = Flush((uint16_t)Mask, (uint16_t)Mask, &Planned);
+    SpanCost = Flush((uint16_t)Mask, Span((uint16_t)Mask), &SpanBurst);
+    FullCost = Flush((uint16_t)Mask, 0xFFFF, &FullBurst);
+
+    if (Cost != OptimalCost((uint16_t)Mask) || Cost > SpanCost || Cost > FullCost)
+    {
+      printf("mask %04lX: planned %lu optimal %lu span %lu full %lu\n",
+             (unsigned long)Mask, (unsigned long)Cost,
+             (unsigned long)OptimalCost((uint16_t)Mask),
+             (unsigned long)SpanCost, (unsigned long)FullCost);
+      Test_Failures++;
+    }
+    Cases++;
+  }
+
+  printf("%lu dirty masks, frame overhead %d bits:\n", (unsigned long)Cases,
+         OVERHEAD);
+  printf("  planner:     %lu clock edges, %lu STB toggles\n",
+         (unsigned long)Planned.Edges, (unsigned long)Planned.StbToggles);
+  printf("  span burst:  %lu clock edges, %lu STB toggles\n",
+         (unsigned long)SpanBurst.Edges, (unsigned long)SpanBurst.StbToggles);
+  printf("  full burst:  %lu clock edges, %lu STB toggles\n",
+         (unsigned long)FullBurst.Edges, (unsigned long)FullBurst.StbToggles);
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,97 @@
+/**
+ **********************************************************************************
+ * @file   test_static_pins.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Compile-time pin binding must send the same frames without callbacks
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+Mock_Chip_t Mock_StaticChip;
+static TM1638_Handler_t Handler;
+
+
+int main(void)
+{
+  const uint8_t Digits[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const uint8_t KeyRegs[4] = {0x02, 0x40, 0x08, 0x10};
+  uint32_t Keys = 0;
+  uint32_t PinCalls;
+  uint8_t i;
+
+  Mock_Init(&Mock_StaticChip, &Handler);
+  memcpy(Mock_StaticChip.Keys, KeyRegs, 4);
+
+  // Pin callbacks of the handler must not be used
+  Handler.DioConfigOut = NULL;
+  Handler.DioConfigIn = NULL;
+  Handler.DioWrite = NULL;
+  Handler.DioRead = NULL;
+  Handler.ClkWrite = NULL;
+  Handler.StbWrite = NULL;
+
+  TM1638_Init(&Handler, TM1638DisplayTypeComCathode);
+  TM1638_ConfigDisplay(&Handler, 3, TM1638DisplayStateON);
+  TM1638_SetMultipleDigit_HEX(&Handler, Digits, 0, 8);
+  TEST_CHECK(Mock_StaticChip.Errors == 0);
+  TEST_CHECK(Mock_StaticChip.Control == 0x8B);
+  TEST_CHECK(memcmp(Mock_StaticChip.Ram, Handler.DisplayRegister, 16) == 0);
+  TEST_CHECK(Mock_StaticChip.Ram[0] == 0x06 && Mock_StaticChip.Ram[7] == 0x7F);
+
+  TM1638_ScanKeys(&Handler, &Keys);
+  TEST_CHECK(Mock_StaticChip.Errors == 0);
+  TEST_CHECK(Keys != 0);
+  {
+    const Mock_Frame_t *Frame = &Mock_StaticChip.Frames[Mock_StaticChip.NumFrames - 1];
+
+    TEST_CHECK(Frame->Length == 1 && Frame->Data[0] == 0x42 && Frame->Read == 4);
+  }
+
+  // Pin calls of a 16-byte flush, all of them inlined direct calls
+  for (i = 0; i < 16; i++)
+    Handler.DisplayRegister[i] = (uint8_t)(i * 29 + 1);
+  Handler.DirtyMask = 0xFFFF;
+  Mock_Clear(&Mock_StaticChip);
+  TM1638_Flush(&Handler);
+  TEST_CHECK(Mock_StaticChip.Errors == 0);
+  TEST_CHECK(memcmp(Mock_StaticChip.Ram, Handler.DisplayRegister, 16) == 0);
+  TEST_CHECK(Mock_StaticChip.Count.ClkEdges == 18 * 8);
+
+  PinCalls = Mock_StaticChip.Count.DioConfig + Mock_StaticChip.Count.DioWrite +
+             Mock_StaticChip.Count.ClkWrite + Mock_StaticChip.Count.StbWrite;
+  printf("16-byte flush with static pins: %lu pin calls, %lu delay calls, "
+         "0 through handler\n",
+         (unsigned long)PinCalls, (unsigned long)Mock_StaticChip.Count.Delay);
+
+  if (Test_Failures)
+    Mock_PrintFrames(&Mock_StaticChip);
+
+  return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+/**
+ **********************************************************************************
+ * @file   test_transfer.c
+ * @author Hossein.M (https://github.com/Hossein-M98)
+ * @brief  Frames sent through Transfer callback must match the bit-banged ones
+ **********************************************************************************
+ *
+ * Copyright (c) 2023 Mahda Embedded System (MIT License)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ **********************************************************************************
+ */
+
+#include <string.h>
+#include "TM1638.h"
+#include "TM1638_mock.h"
+
+
+static TM1638_Handler_t BitHandler, SpiHandler;
+static Mock_Chip_t BitChip, SpiChip;
+
+
+// Run the same calls on both handlers and compare what the chips received
+static void
+Sequence(TM1638_Handler_t *Handler, uint32_t *Keys)
+{
+  const uint8_t Digits[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  const uint8_t Changed[2] = {0x0A, 0x0B};
+
+  TM1638_Init(Handler, TM1638DisplayTypeComCathode);
+  TM1638_ConfigDisplay(Handler, 7, TM1638DisplayStateON);
+  TM1638_SetMultipleDigit_HEX(Handler, Digits, 0, 8);
+  TM1638_SetLeds(Handler, 0xA5);
+  TM1638_SetMultipleDigit_HEX(Handler, Changed, 3, 2);
+  TM1638_SetSingleDigit_HEX(Handler, 0x0F, 7);
+  TM1638_ScanKeys(Handler, Keys);
+}
+
+
+int main(void)
+{
+  const TM1638_Timing_t Fast = {0, 0, 0, 0};
+  const uint8_t KeyRegs[4] = {0x11, 0x22, 0x44, 0x88};
+  uint32_t BitKeys = 0, SpiKeys = 0;
+  uint8_t i;
+
+  Mock_Init(&BitChip, &BitHandler);
+  Mock_Init(&SpiChip, &SpiHandler);
+  Mock_UseTransfer(&SpiHandler);
+  memcpy(BitChip.Keys, KeyRegs, 4);
+  memcpy(SpiChip.Keys, KeyRegs, 4);
+
+  Sequence(&BitHandler, &BitKeys);
+  Sequence(&SpiHandler, &SpiKeys);
+
+  TEST_CHECK(BitChip.Errors == 0);
+  TEST_CHECK(SpiChip.Errors == 0);
+  TEST_CHECK(BitChip.Count.Frames > 0);
+  TEST_CHECK(Mock_SameFrames(&BitChip, &SpiChip));
+  TEST_CHECK(memcmp(BitChip.Ram, SpiChip.Ram, 16) == 0);
+  TEST_CHECK(BitChip.Control == 0x8F && SpiChip.Control == 0x8F);
+  TEST_CHECK(BitKeys == SpiKeys && BitKeys != 0);
+  TEST_CHECK(SpiChip.Count.Transfer == SpiChip.Count.Frames);
+  TEST_CHECK(SpiChip.Count.ClkWrite == 0 && SpiChip.Count.StbWrite == 0);
+
+  // The image held by the library is what the chip shows
+  for (i = 0; i < 16; i++)
+    TEST_CHECK(SpiChip.Ram[i] == SpiHandler.DisplayRegister[i]);
+
+  // Key scan frame is the read command and 4 bytes, after ReadWait (5us)
+  {
+    const Mock_Frame_t *Frame = &SpiChip.Frames[SpiChip.NumFrames - 1];
+
+    TEST_CHECK(Frame->Length == 1 && Frame->Data[0] == 0x42);
+    TEST_CHECK(Frame->Read == 4 && Frame->Wait == 5);
+  }
+
+  // Transfer gets the timing profile set by TM1638_SetTiming()
+  Mock_Clear(&BitChip);
+  Mock_Clear(&SpiChip);
+  TM1638_SetTiming(&BitHandler, &Fast);
+  TM1638_SetTiming(&SpiHandler, &Fast);
+  TM1638_ScanKeys(&BitHandler, &BitKeys);
+  TM1638_ScanKeys(&SpiHandler, &SpiKeys);
+  TEST_CHECK(Mock_SameFrames(&BitChip, &SpiChip));
+  TEST_CHECK(SpiChip.Frames[0].Wait == 0);
+  TEST_CHECK(BitChip.Count.Delay == 0);
+
+  // A full flush is one data command and one burst of 16 registers
+  Mock_Clear(&SpiChip);
+  for (i = 0; i < 16; i++)
+    SpiHandler.DisplayRegister[i] ^= 0xFF;
+  SpiHandler.DirtyMask = 0xFFFF;
+  TM1638_Flush(&SpiHandler);
+  TEST_CHECK(SpiChip.NumFrames == 2);
+  TEST_CHECK(SpiChip.Frames[0].Length == 1 && SpiChip.Frames[0].Data[0] == 0x40);
+  TEST_CHECK(SpiChip.Frames[1].Length == 17 && SpiChip.Frames[1].Data[0] == 0xC0);
+  TEST_CHECK(memcmp(SpiChip.Ram, SpiHandler.DisplayRegister, 16) == 0);
+
+  if (Test_Failures)
+  {
+    Mock_PrintFrames(&BitChip);
+    Mock_PrintFrames(&SpiChip);
+  }
+
+  return TEST_RESULT();
+}